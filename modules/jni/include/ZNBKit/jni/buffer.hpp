@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <cstddef>
 #include <jni.h>
 #include <ranges>
+#include <span>
+#include <stdexcept>
 
 namespace znb_kit
 {
@@ -21,5 +24,46 @@ namespace znb_kit
         static int set_ptr_byte(JNIEnv *env, const jbyteArray &buffer, const int8_t *array, int array_length, int buffer_offset = 0);
 
         static int get_ptr_byte(JNIEnv *env, const jbyteArray &buffer, int8_t *array, int array_length, int buffer_offset = 0);
+
+        /*
+         * Memory behind a direct ByteBuffer. Throws for heap buffers, which have no stable address.
+         */
+        static std::span<std::byte> get_direct(JNIEnv *env, const jobject &byte_buffer);
+
+        /*
+         * Runs fn over the array contents inside GetPrimitiveArrayCritical, so fn must not call back into JNI or block.
+         * Changes are written back only when commit is set.
+         */
+        template <typename Fn>
+        static decltype(auto) with_critical(JNIEnv *env, const jarray &buffer, const bool commit, Fn &&fn)
+        {
+            if (buffer == nullptr)
+            {
+                throw std::invalid_argument("buffer is null");
+            }
+
+            const auto length = static_cast<size_t>(env->GetArrayLength(buffer));
+            auto *data = static_cast<std::byte *>(env->GetPrimitiveArrayCritical(buffer, nullptr));
+
+            if (data == nullptr)
+            {
+                throw std::runtime_error("GetPrimitiveArrayCritical failed");
+            }
+
+            struct release_guard
+            {
+                JNIEnv *env;
+                jarray buffer;
+                std::byte *data;
+                jint mode;
+
+                ~release_guard()
+                {
+                    env->ReleasePrimitiveArrayCritical(buffer, data, mode);
+                }
+            } guard{env, buffer, data, commit ? 0 : JNI_ABORT};
+
+            return fn(std::span(data, length));
+        }
     };
 }
\ No newline at end of file
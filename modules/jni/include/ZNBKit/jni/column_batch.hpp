@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <jni.h>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace znb_kit
+{
+    enum column_type : uint8_t
+    {
+        INT8,
+        INT16,
+        INT32,
+        INT64,
+        FLOAT32,
+        FLOAT64,
+        UTF8,
+    };
+
+    struct column_spec
+    {
+        std::string name;
+        column_type type;
+
+        bool nullable = true;
+    };
+
+    template <typename T>
+    constexpr std::optional<column_type> column_type_of()
+    {
+        if constexpr (std::is_same_v<T, int8_t>) return INT8;
+        else if constexpr (std::is_same_v<T, int16_t>) return INT16;
+        else if constexpr (std::is_same_v<T, int32_t>) return INT32;
+        else if constexpr (std::is_same_v<T, int64_t>) return INT64;
+        else if constexpr (std::is_same_v<T, float>) return FLOAT32;
+        else if constexpr (std::is_same_v<T, double>) return FLOAT64;
+        else return std::nullopt;
+    }
+
+    size_t get_column_width(column_type type);
+
+    /*
+     * Non-owning view of one column: an optional validity bitmap (bit set = value present, LSB first), then either
+     * fixed-width little-endian values or int32 offsets (rows + 1) into UTF-8 data. Used for batches built natively as
+     * well as for batches handed over by Java.
+     */
+    class column_view
+    {
+        column_type type = INT32;
+        size_t length = 0;
+
+        const uint8_t *validity = nullptr;
+        const std::byte *values = nullptr;
+        const int32_t *offsets = nullptr;
+        const char *data = nullptr;
+
+        template <typename T>
+        void check_type() const
+        {
+            if (column_type_of<T>() != type)
+            {
+                throw std::invalid_argument("Column type does not match the requested value type");
+            }
+        }
+
+    public:
+        column_view() = default;
+
+        column_view(const column_type type, const size_t length, const uint8_t *validity, const std::byte *values,
+                    const int32_t *offsets, const char *data)
+            : type(type), length(length), validity(validity), values(values), offsets(offsets), data(data)
+        {
+        }
+
+        [[nodiscard]] column_type get_type() const
+        {
+            return type;
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return length;
+        }
+
+        [[nodiscard]] bool is_valid(const size_t row) const
+        {
+            return validity == nullptr || (validity[row >> 3] >> (row & 7) & 1) != 0;
+        }
+
+        template <typename T>
+        [[nodiscard]] std::span<const T> get_values() const
+        {
+            check_type<T>();
+            return {reinterpret_cast<const T *>(values), length};
+        }
+
+        [[nodiscard]] std::string_view get_string(const size_t row) const
+        {
+            if (type != UTF8)
+            {
+                throw std::invalid_argument("Column is not a string column");
+            }
+
+            return {data + offsets[row], static_cast<size_t>(offsets[row + 1] - offsets[row])};
+        }
+
+        /*
+         * Popcount over the bitmap, a word at a time.
+         */
+        [[nodiscard]] size_t null_count() const;
+
+        template <typename T>
+        [[nodiscard]] std::optional<T> min() const
+        {
+            return reduce<T>([](const T a, const T b) { return b < a ? b : a; });
+        }
+
+        template <typename T>
+        [[nodiscard]] std::optional<T> max() const
+        {
+            return reduce<T>([](const T a, const T b) { return a < b ? b : a; });
+        }
+
+        /*
+         * Runs of 64 rows that are all valid (or a column without a bitmap) reduce in a branch-free inner loop the
+         * compiler can vectorize; mixed runs fall back to testing each bit.
+         */
+        template <typename T, typename Fn>
+        [[nodiscard]] std::optional<T> reduce(Fn &&fn) const
+        {
+            const auto items = get_values<T>();
+
+            std::optional<T> result;
+
+            for (size_t base = 0; base < length; base += 64)
+            {
+                const size_t end = std::min(base + 64, length);
+                uint64_t mask = ~uint64_t{0};
+
+                if (validity != nullptr)
+                {
+                    mask = 0;
+                    std::memcpy(&mask, validity + base / 8, (end - base + 7) / 8);
+                }
+
+                if (end - base < 64)
+                {
+                    mask &= (uint64_t{1} << (end - base)) - 1;
+                }
+
+                if (mask == 0)
+                {
+                    continue;
+                }
+
+                if (std::popcount(mask) == static_cast<int>(end - base))
+                {
+                    T accumulator = items[base];
+
+                    for (size_t i = base + 1; i < end; ++i)
+                    {
+                        accumulator = fn(accumulator, items[i]);
+                    }
+
+                    result = result ? fn(*result, accumulator) : accumulator;
+                    continue;
+                }
+
+                for (; mask != 0; mask &= mask - 1)
+                {
+                    const T item = items[base + std::countr_zero(mask)];
+                    result = result ? fn(*result, item) : item;
+                }
+            }
+
+            return result;
+        }
+    };
+
+    /*
+     * Owning columnar batch filled natively. Every column keeps its own buffers; to_java() exposes them as direct
+     * ByteBuffers without copying, so the batch has to outlive the Java side's use of them and must not be appended
+     * to in the meantime (appending can reallocate).
+     */
+    class column_batch
+    {
+        struct column
+        {
+            std::vector<uint8_t> validity;
+            std::vector<std::byte> values;
+            std::vector<int32_t> offsets;
+            std::vector<char> data;
+
+            size_t length = 0;
+        };
+
+        std::vector<column_spec> schema;
+        std::vector<column> columns;
+
+        column &get_column(size_t index, column_type type);
+
+        void mark(size_t index, bool valid);
+
+        template <typename T>
+        static void store(std::byte *out, const T value)
+        {
+            static_assert(std::endian::native == std::endian::little, "Columnar batches assume a little-endian host");
+            std::memcpy(out, &value, sizeof(T));
+        }
+
+    public:
+        explicit column_batch(std::vector<column_spec> schema, size_t capacity = 1024);
+
+        template <typename T> requires (column_type_of<T>().has_value())
+        void append(const size_t index, const T value)
+        {
+            auto &column = get_column(index, *column_type_of<T>());
+
+            column.values.resize((column.length + 1) * sizeof(T));
+            store(column.values.data() + column.length * sizeof(T), value);
+
+            mark(index, true);
+        }
+
+        void append(size_t index, std::string_view value);
+
+        void append_null(size_t index);
+
+        /*
+         * Rows of the batch; throws when columns were filled to different lengths.
+         */
+        [[nodiscard]] size_t rows() const;
+
+        [[nodiscard]] size_t column_count() const
+        {
+            return columns.size();
+        }
+
+        [[nodiscard]] const std::vector<column_spec> &get_schema() const
+        {
+            return schema;
+        }
+
+        [[nodiscard]] column_view view(size_t index) const;
+
+        void clear();
+
+        /*
+         * ByteBuffer[3 * columns]: {validity, values or offsets, string data} per column, null where a buffer does not
+         * apply. All buffers are little-endian; Java has to set ByteOrder.LITTLE_ENDIAN on them.
+         */
+        jobjectArray to_java(JNIEnv *env) const;
+
+        /*
+         * {"rows":..,"columns":[{"name":..,"type":..,"nullable":..}]}
+         */
+        [[nodiscard]] std::string describe() const;
+    };
+
+    /*
+     * Batch produced by Java as the same ByteBuffer[3 * columns] layout. Buffers have to be direct; views point
+     * straight into them and stay valid only as long as the Java buffers are alive.
+     */
+    class column_batch_reader
+    {
+        std::vector<column_view> columns;
+        size_t row_count = 0;
+
+    public:
+        column_batch_reader(JNIEnv *env, const jobjectArray &buffers, const std::vector<column_spec> &schema, size_t rows);
+
+        [[nodiscard]] size_t rows() const
+        {
+            return row_count;
+        }
+
+        [[nodiscard]] const column_view &column(const size_t index) const
+        {
+            return columns.at(index);
+        }
+    };
+}
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <jni.h>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ZNBKit/internal/util.hpp"
+#include "ZNBKit/jni/buffer.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Scalar and variable-length types a flat record can carry. Scalars are stored inline; strings (UTF-8) and vectors
+     * of scalars take an 8-byte slot holding their offset from the record start and their length, with the data in
+     * the record's variable section.
+     */
+    template <typename T>
+    struct flat_type;
+
+#define FLAT_SCALAR(TYPE, JAVA) \
+    template <> \
+    struct flat_type<TYPE> \
+    { \
+        static constexpr bool variable = false; \
+        static constexpr size_t size = sizeof(TYPE); \
+        static std::string java_name() { return JAVA; } \
+    };
+
+    FLAT_SCALAR(jboolean, "boolean")
+    FLAT_SCALAR(jbyte, "byte")
+    FLAT_SCALAR(jchar, "char")
+    FLAT_SCALAR(jshort, "short")
+    FLAT_SCALAR(jint, "int")
+    FLAT_SCALAR(jlong, "long")
+    FLAT_SCALAR(jfloat, "float")
+    FLAT_SCALAR(jdouble, "double")
+
+#undef FLAT_SCALAR
+
+    template <>
+    struct flat_type<std::string>
+    {
+        static constexpr bool variable = true;
+        static constexpr size_t size = 8;
+        static constexpr size_t element_size = 1;
+
+        static std::string java_name()
+        {
+            return "String";
+        }
+    };
+
+    template <typename E>
+    struct flat_type<std::vector<E>>
+    {
+        static_assert(!flat_type<E>::variable, "Flat records only support vectors of scalars");
+
+        static constexpr bool variable = true;
+        static constexpr size_t size = 8;
+        static constexpr size_t element_size = flat_type<E>::size;
+
+        static std::string java_name()
+        {
+            return flat_type<E>::java_name() + "[]";
+        }
+    };
+
+    template <auto Member>
+    struct flat_field
+    {
+        std::string_view name;
+    };
+
+    /*
+     * Schema for encoding an aggregate S into a flat little-endian record:
+     *
+     *   [u32 size][u32 schema id][fixed section][variable section]
+     *
+     * Field offsets in the fixed section are computed at compile time in declaration order with natural alignment;
+     * records and variable chunks are 8-byte aligned, so consecutive records in one buffer can be walked by size.
+     * describe() renders the same layout as JSON for generating the Java-side accessors.
+     */
+    template <typename S, auto... Members>
+    class flat_schema
+    {
+        template <typename>
+        struct member_value;
+
+        template <typename C, typename V>
+        struct member_value<V C::*>
+        {
+            using owner = C;
+            using type = V;
+        };
+
+        template <auto Member>
+        using value_of = typename member_value<decltype(Member)>::type;
+
+        static_assert((std::is_same_v<typename member_value<decltype(Members)>::owner, S> && ...),
+                      "Every schema member has to belong to the encoded aggregate");
+
+        static constexpr size_t count = sizeof...(Members);
+        static constexpr size_t header_size = 8;
+
+        static constexpr size_t align(const size_t value, const size_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        static constexpr std::array<size_t, count> sizes = {flat_type<value_of<Members>>::size...};
+
+        static constexpr std::array<size_t, count> compute_offsets()
+        {
+            std::array<size_t, count> result{};
+            size_t cursor = header_size;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                cursor = align(cursor, sizes[i]);
+                result[i] = cursor;
+                cursor += sizes[i];
+            }
+
+            return result;
+        }
+
+        static constexpr std::array<size_t, count> offsets = compute_offsets();
+
+        template <typename T>
+        using bits_of = std::conditional_t<sizeof(T) == 1, uint8_t,
+                        std::conditional_t<sizeof(T) == 2, uint16_t,
+                        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+        template <typename T>
+        static void store(std::byte *out, const T value)
+        {
+            auto bits = std::bit_cast<bits_of<T>>(value);
+
+            if constexpr (std::endian::native == std::endian::big)
+            {
+                bits = std::byteswap(bits);
+            }
+
+            std::memcpy(out, &bits, sizeof(bits));
+        }
+
+        template <typename T>
+        static T load(const std::byte *in)
+        {
+            bits_of<T> bits;
+            std::memcpy(&bits, in, sizeof(bits));
+
+            if constexpr (std::endian::native == std::endian::big)
+            {
+                bits = std::byteswap(bits);
+            }
+
+            return std::bit_cast<T>(bits);
+        }
+
+        template <typename V>
+        static size_t variable_size(const V &value)
+        {
+            if constexpr (flat_type<V>::variable)
+            {
+                return align(value.size() * flat_type<V>::element_size, 8);
+            }
+            else
+            {
+                return 0;
+            }
+        }
+
+        template <typename V>
+        static void encode_member(const V &value, std::byte *record, const size_t offset, size_t &cursor)
+        {
+            if constexpr (!flat_type<V>::variable)
+            {
+                store(record + offset, value);
+            }
+            else
+            {
+                store(record + offset, static_cast<uint32_t>(cursor));
+                store(record + offset + 4, static_cast<uint32_t>(value.size()));
+
+                if constexpr (std::is_same_v<V, std::string>)
+                {
+                    std::memcpy(record + cursor, value.data(), value.size());
+                }
+                else
+                {
+                    for (size_t i = 0; i < value.size(); ++i)
+                    {
+                        store(record + cursor + i * flat_type<V>::element_size, value[i]);
+                    }
+                }
+
+                cursor += variable_size(value);
+            }
+        }
+
+        template <typename V>
+        static void decode_member(V &value, const std::byte *record, const size_t size, const size_t offset)
+        {
+            if constexpr (!flat_type<V>::variable)
+            {
+                value = load<V>(record + offset);
+            }
+            else
+            {
+                const size_t begin = load<uint32_t>(record + offset);
+                const size_t length = load<uint32_t>(record + offset + 4);
+
+                if (begin < fixed_size || begin + length * flat_type<V>::element_size > size)
+                {
+                    throw std::out_of_range("Flat record variable field points outside of the record");
+                }
+
+                if constexpr (std::is_same_v<V, std::string>)
+                {
+                    value.assign(reinterpret_cast<const char *>(record + begin), length);
+                }
+                else
+                {
+                    value.resize(length);
+
+                    for (size_t i = 0; i < length; ++i)
+                    {
+                        value[i] = load<typename V::value_type>(record + begin + i * flat_type<V>::element_size);
+                    }
+                }
+            }
+        }
+
+        std::array<std::string_view, count> names;
+        uint32_t id;
+
+    public:
+        static constexpr size_t fixed_size = align(count == 0 ? header_size : offsets[count - 1] + sizes[count - 1], 8);
+
+        explicit flat_schema(const flat_field<Members> &... fields): names{fields.name...}
+        {
+            /*
+             * FNV-1a over names and Java types, truncated; lets the reader reject records written with another layout.
+             */
+            uint64_t key = 0xcbf29ce484222325ULL;
+            size_t i = 0;
+
+            const auto mix = [&key](const std::string_view value) {
+                for (const unsigned char c : value)
+                {
+                    key ^= c;
+                    key *= 0x100000001b3ULL;
+                }
+            };
+
+            ((mix(names[i++]), mix(flat_type<value_of<Members>>::java_name())), ...);
+
+            id = static_cast<uint32_t>(key ^ key >> 32);
+        }
+
+        [[nodiscard]] uint32_t get_id() const
+        {
+            return id;
+        }
+
+        [[nodiscard]] size_t encoded_size(const S &record) const
+        {
+            return fixed_size + (variable_size(record.*Members) + ... + 0);
+        }
+
+        size_t encode(const S &record, const std::span<std::byte> out) const
+        {
+            const size_t size = encoded_size(record);
+
+            if (out.size() < size)
+            {
+                throw std::length_error("Buffer too small for flat record");
+            }
+
+            if (size > UINT32_MAX)
+            {
+                throw std::length_error("Flat record exceeds 4 GiB");
+            }
+
+            std::byte *data = out.data();
+            std::memset(data, 0, size);
+
+            store(data, static_cast<uint32_t>(size));
+            store(data + 4, id);
+
+            size_t cursor = fixed_size;
+            size_t i = 0;
+
+            (encode_member(record.*Members, data, offsets[i++], cursor), ...);
+
+            return size;
+        }
+
+        size_t decode(const std::span<const std::byte> in, S &record) const
+        {
+            if (in.size() < header_size)
+            {
+                throw std::out_of_range("Flat record is truncated");
+            }
+
+            const size_t size = load<uint32_t>(in.data());
+
+            if (size < fixed_size || size > in.size())
+            {
+                throw std::out_of_range("Flat record size is invalid");
+            }
+
+            if (load<uint32_t>(in.data() + 4) != id)
+            {
+                throw std::invalid_argument("Flat record was written with a different schema");
+            }
+
+            size_t i = 0;
+            (decode_member(record.*Members, in.data(), size, offsets[i++]), ...);
+
+            return size;
+        }
+
+        [[nodiscard]] size_t encoded_size(const std::span<const S> records) const
+        {
+            size_t total = 0;
+
+            for (const auto &record : records)
+            {
+                total += encoded_size(record);
+            }
+
+            return total;
+        }
+
+        size_t encode(const std::span<const S> records, const std::span<std::byte> out) const
+        {
+            size_t written = 0;
+
+            for (const auto &record : records)
+            {
+                written += encode(record, out.subspan(written));
+            }
+
+            return written;
+        }
+
+        [[nodiscard]] std::vector<S> decode(std::span<const std::byte> in) const
+        {
+            std::vector<S> records;
+
+            while (!in.empty())
+            {
+                S record{};
+                in = in.subspan(decode(in, record));
+
+                records.push_back(std::move(record));
+            }
+
+            return records;
+        }
+
+        /*
+         * One new byte[] holding all records, encoded straight into the array inside a critical section.
+         */
+        jbyteArray to_byte_array(JNIEnv *env, const std::span<const S> records) const
+        {
+            const size_t size = encoded_size(records);
+
+            if (size > INT32_MAX)
+            {
+                throw std::length_error("Flat records do not fit into a Java array");
+            }
+
+            const auto array = env->NewByteArray(static_cast<jsize>(size));
+
+            if (array == nullptr)
+            {
+                throw std::runtime_error("Failed to allocate byte[] for flat records");
+            }
+
+            buffer::with_critical(env, array, true, [&](const std::span<std::byte> data) {
+                encode(records, data);
+            });
+
+            return array;
+        }
+
+        std::vector<S> from_byte_array(JNIEnv *env, const jbyteArray &array) const
+        {
+            return buffer::with_critical(env, array, false, [&](const std::span<std::byte> data) {
+                return decode(std::span<const std::byte>(data));
+            });
+        }
+
+        /*
+         * Encodes into a direct ByteBuffer at `offset` and returns the number of bytes written.
+         */
+        size_t write_direct(JNIEnv *env, const jobject &byte_buffer, const std::span<const S> records, const size_t offset = 0) const
+        {
+            const auto data = buffer::get_direct(env, byte_buffer);
+
+            if (offset > data.size())
+            {
+                throw std::out_of_range("Offset is past the end of the buffer");
+            }
+
+            return encode(records, data.subspan(offset));
+        }
+
+        std::vector<S> read_direct(JNIEnv *env, const jobject &byte_buffer, const size_t offset, const size_t length) const
+        {
+            const auto data = buffer::get_direct(env, byte_buffer);
+
+            if (offset > data.size() || length > data.size() - offset)
+            {
+                throw std::out_of_range("Range is outside of the buffer");
+            }
+
+            return decode(std::span<const std::byte>(data.subspan(offset, length)));
+        }
+
+        /*
+         * {"id":..,"fixed_size":..,"fields":[{"name":..,"type":..,"offset":..,"variable":..}]}
+         */
+        [[nodiscard]] std::string describe() const
+        {
+            const std::array<std::string, count> types = {flat_type<value_of<Members>>::java_name()...};
+            const std::array<bool, count> variable = {flat_type<value_of<Members>>::variable...};
+
+            std::string json = std::format("{{\"id\":{},\"fixed_size\":{},\"fields\":[", id, fixed_size);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                json += std::format("{}{{\"name\":\"{}\",\"type\":\"{}\",\"offset\":{},\"variable\":{}}}",
+                    i == 0 ? "" : ",", escape_json(names[i]), types[i], offsets[i], variable[i]);
+            }
+
+            return json + "]}";
+        }
+    };
+
+    template <typename S, auto... Members>
+    flat_schema<S, Members...> make_flat_schema(const flat_field<Members> &... fields)
+    {
+        return flat_schema<S, Members...>(fields...);
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <jni.h>
+#include <memory>
+#include <optional>
+#include <span>
+
+namespace znb_kit
+{
+    /*
+     * A file mapped into memory once and shared by native code and Java, so large inputs are worked on in the page
+     * cache instead of being copied through the Java heap.
+     *
+     * Instances only exist behind a shared_ptr. Every window handed to Java pins the mapping, so the mapping outlives
+     * the last native owner for as long as Java holds a window. A pin is dropped when the buffer is passed back to
+     * release(), or by a sweep once the buffer has been collected: pins keep a weak ref to their buffer and are swept
+     * on window() when their number has doubled since the last sweep, or explicitly through sweep(). Windows of a
+     * read-only mapping are read-only ByteBuffers, since a write through them would fault the VM.
+     */
+    class mapped_file : public std::enable_shared_from_this<mapped_file>
+    {
+    public:
+        enum access_mode : uint8_t
+        {
+            READ_ONLY,
+            READ_WRITE,
+        };
+
+        enum advice : uint8_t
+        {
+            NORMAL,
+            SEQUENTIAL,
+            RANDOM,
+            WILL_NEED,
+            DONT_NEED,
+        };
+
+        struct options
+        {
+            access_mode access = READ_ONLY;
+            advice hint = NORMAL;
+
+            /*
+             * Fault every page in up front instead of on first access.
+             */
+            bool populate = false;
+
+            /*
+             * Read-write only: creates the file if missing and resizes it before mapping.
+             */
+            std::optional<size_t> size;
+        };
+
+        static std::shared_ptr<mapped_file> open(const std::filesystem::path &path);
+
+        static std::shared_ptr<mapped_file> open(const std::filesystem::path &path, const options &options);
+
+        mapped_file(const mapped_file &) = delete;
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        ~mapped_file();
+
+        [[nodiscard]] std::span<std::byte> get_data() const
+        {
+            return {data, length};
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return length;
+        }
+
+        [[nodiscard]] const std::filesystem::path &get_path() const
+        {
+            return path;
+        }
+
+        [[nodiscard]] bool is_writable() const
+        {
+            return access == READ_WRITE;
+        }
+
+        void advise(advice hint, size_t offset = 0, std::optional<size_t> count = std::nullopt) const;
+
+        /*
+         * msync over the range; read-write mappings only.
+         */
+        void sync(size_t offset = 0, std::optional<size_t> count = std::nullopt, bool async = false) const;
+
+        /*
+         * Direct ByteBuffer over [offset, offset + count), pinning the mapping until release() or until the buffer is
+         * collected and swept.
+         */
+        jobject window(JNIEnv *env, size_t offset = 0, std::optional<size_t> count = std::nullopt);
+
+        /*
+         * Drops the pin taken for a window; false when the buffer is not a live window.
+         */
+        static bool release(JNIEnv *env, const jobject &window);
+
+        /*
+         * Drops the pins of windows Java has already collected and returns how many there were.
+         */
+        static size_t sweep(JNIEnv *env);
+
+        /*
+         * Windows of this mapping still held by Java.
+         */
+        [[nodiscard]] size_t get_windows() const
+        {
+            return windows.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::filesystem::path path;
+        access_mode access;
+
+        std::byte *data = nullptr;
+        size_t length = 0;
+
+        std::atomic<size_t> windows{0};
+
+        mapped_file(std::filesystem::path path, access_mode access, std::byte *data, size_t length);
+
+        [[nodiscard]] std::span<std::byte> get_range(size_t offset, std::optional<size_t> count) const;
+    };
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <jni.h>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "ZNBKit/internal/spsc_ring.hpp"
+#include "ZNBKit/jni/signatures/class_handle.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Message ring in native memory that Java maps as a single direct ByteBuffer, so streaming data across the bridge
+     * costs no JNI transition per message.
+     *
+     * Layout (little-endian):
+     *   [0]    u32 magic, u32 version, u64 capacity, u32 producers
+     *   [128]  u64 tail    - claim position, owned by producers
+     *   [256]  u64 head    - consume position, owned by the consumer
+     *   [384]  i32 waiting - non-zero while a Java consumer is parked
+     *   [512]  data, `capacity` bytes
+     *
+     * Every index sits on its own pair of cache lines so adjacent-line prefetch does not make producer and consumer
+     * share one. A record is [i32 length][i32 type][payload] padded to 8 bytes, where length counts the 8-byte record
+     * header but not the padding. A producer claims space by moving the tail, writes type and payload and publishes
+     * the record by storing its length last with release semantics; the consumer reads length with acquire and stops
+     * at zero. Consumed bytes are zeroed before head moves past them, so a zero length always means "not yet
+     * published". A record that would straddle the end of the ring is preceded by a PADDING record up to the end.
+     *
+     * A Java consumer does the same with VarHandle acquire/release accesses on the buffer. Before parking it stores 1
+     * into `waiting`, re-checks the record at head and then calls LockSupport.park(); producers that see the flag
+     * after publishing wake a helper thread that unparks the thread registered with set_consumer(), so producers
+     * never need a JNIEnv of their own.
+     */
+    class shared_ring
+    {
+    public:
+        enum producer_mode : uint32_t
+        {
+            SINGLE_PRODUCER,
+            MULTI_PRODUCER
+        };
+
+        static constexpr uint32_t MAGIC = 0x524E425A; // "ZNBR"
+        static constexpr uint32_t VERSION = 1;
+
+        static constexpr size_t TAIL_OFFSET = 2 * cache_line_size;
+        static constexpr size_t HEAD_OFFSET = 4 * cache_line_size;
+        static constexpr size_t WAITING_OFFSET = 6 * cache_line_size;
+        static constexpr size_t HEADER_SIZE = 8 * cache_line_size;
+
+        static constexpr size_t RECORD_HEADER = 8;
+        static constexpr size_t RECORD_ALIGNMENT = 8;
+
+        static constexpr int32_t PADDING = -1;
+
+        struct options
+        {
+            /*
+             * Bytes of record data, rounded up to a power of two.
+             */
+            size_t capacity = 1 << 20;
+            producer_mode producers = SINGLE_PRODUCER;
+        };
+
+        explicit shared_ring(const options &options);
+
+        shared_ring(const shared_ring &) = delete;
+        shared_ring &operator=(const shared_ring &) = delete;
+
+        /*
+         * The memory goes away with the ring; Java must have dropped its buffer by then.
+         */
+        ~shared_ring();
+
+        /*
+         * Direct ByteBuffer over the whole ring, header included.
+         */
+        jobject to_java(JNIEnv *env) const;
+
+        /*
+         * {"capacity":..,"header_size":..,"tail_offset":..,"head_offset":..,"waiting_offset":..,...}
+         */
+        [[nodiscard]] std::string describe() const;
+
+        /*
+         * Thread to unpark when a Java consumer is waiting. Starts the helper thread, attached to the VM as a daemon,
+         * that does the unparking on behalf of producers.
+         */
+        void set_consumer(JNIEnv *env, const jobject &thread);
+
+        /*
+         * Stops the helper thread and drops the consumer. Producers may keep writing; they just stop waking anyone.
+         */
+        void release(JNIEnv *env);
+
+        /*
+         * False when the ring is full or the payload can never fit; nothing is written then.
+         */
+        bool try_write(int32_t type, std::span<const std::byte> payload);
+
+        /*
+         * Claims space for all messages at once and publishes them together: either all of them are written or none.
+         */
+        bool try_write_batch(int32_t type, std::span<const std::span<const std::byte>> messages);
+
+        /*
+         * Native consumer side. Hands up to `limit` records to fn(type, payload) and moves head once for the batch.
+         * The payload span is only valid inside fn.
+         */
+        template <typename Fn>
+        size_t read(Fn &&fn, const size_t limit = std::numeric_limits<size_t>::max())
+        {
+            auto head_ref = index(HEAD_OFFSET);
+
+            const uint64_t begin = head_ref.load(std::memory_order_relaxed);
+            uint64_t head = begin;
+            size_t count = 0;
+
+            while (count < limit)
+            {
+                std::byte *record = data + (head & mask);
+                const int32_t length = length_at(record).load(std::memory_order_acquire);
+
+                if (length <= 0)
+                {
+                    break;
+                }
+
+                int32_t type;
+                std::memcpy(&type, record + 4, sizeof(type));
+
+                if (type != PADDING)
+                {
+                    fn(type, std::span<const std::byte>(record + RECORD_HEADER, static_cast<size_t>(length) - RECORD_HEADER));
+                    ++count;
+                }
+
+                const size_t size = align(static_cast<size_t>(length));
+
+                std::memset(record, 0, size);
+                head += size;
+            }
+
+            if (head != begin)
+            {
+                head_ref.store(head, std::memory_order_release);
+            }
+
+            return count;
+        }
+
+        /*
+         * Whether a published record is waiting at head.
+         */
+        [[nodiscard]] bool available() const;
+
+        /*
+         * Native consumer wait: spins, then yields, then sleeps with a growing backoff until a record is published or
+         * the timeout passes. Producers on the Java side cannot signal a native waiter, hence no futex.
+         */
+        bool wait(std::chrono::nanoseconds timeout) const;
+
+        [[nodiscard]] size_t get_capacity() const
+        {
+            return capacity;
+        }
+
+        /*
+         * Bytes claimed but not consumed yet, padding included.
+         */
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] size_t get_rejected() const
+        {
+            return rejected.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t get_wakeups() const
+        {
+            return wakeups.load(std::memory_order_relaxed);
+        }
+
+        /*
+         * Unpark calls that raised a Java exception. The exception is cleared, not printed.
+         */
+        [[nodiscard]] size_t get_failed_wakeups() const
+        {
+            return failed_wakeups.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct free_deleter
+        {
+            void operator()(std::byte *memory) const;
+        };
+
+        size_t capacity;
+        size_t mask;
+        producer_mode producers;
+
+        std::unique_ptr<std::byte[], free_deleter> memory;
+        std::byte *data;
+
+        /*
+         * Last head seen by the single producer, so it only touches the consumer's cache line when the ring looks
+         * full.
+         */
+        uint64_t cached_head = 0;
+
+        /*
+         * Only touched by set_consumer(), release() and the waker thread, which release() joins before it resets them.
+         */
+        jobject consumer = nullptr;
+        class_handle lock_support;
+        jmethodID unpark = nullptr;
+
+        std::thread waker;
+        std::atomic_bool waking{false};
+        std::atomic_bool wake_pending{false};
+
+        std::atomic<size_t> rejected{0};
+        std::atomic<size_t> wakeups{0};
+        std::atomic<size_t> failed_wakeups{0};
+
+        static constexpr size_t align(const size_t size)
+        {
+            return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+        }
+
+        [[nodiscard]] std::atomic_ref<uint64_t> index(const size_t offset) const
+        {
+            return std::atomic_ref(*reinterpret_cast<uint64_t *>(memory.get() + offset));
+        }
+
+        static std::atomic_ref<int32_t> length_at(std::byte *record)
+        {
+            return std::atomic_ref(*reinterpret_cast<int32_t *>(record));
+        }
+
+        /*
+         * Moves the tail by `size` bytes of contiguous space and returns where the space starts, emitting a PADDING
+         * record first when the space would wrap.
+         */
+        std::optional<uint64_t> claim(size_t size);
+
+        static void write(std::byte *record, int32_t type, std::span<const std::byte> payload);
+
+        void signal();
+
+        void wake_consumer(JavaVM *vm);
+
+        void stop_waker();
+    };
+}
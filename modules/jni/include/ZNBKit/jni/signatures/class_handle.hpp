@@ -0,0 +1,59 @@
+#pragma once
+
+#include <jni.h>
+#include <memory>
+#include <type_traits>
+
+#include "ZNBKit/internal/thread_env.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Reference-counted global ref to a class. Copies share one global ref, which is deleted with the last copy using
+     * the env of whichever thread that happens on, so a class mapped with hundreds of methods costs a single entry in
+     * the JNI global table and in the tracker.
+     */
+    class class_handle
+    {
+        std::shared_ptr<std::remove_pointer_t<jclass>> klass;
+
+    public:
+        class_handle() = default;
+
+        class_handle(JNIEnv *jni, const jclass &klass)
+        {
+            VAR_CHECK(jni);
+            VAR_CHECK(klass);
+
+            thread_env::adopt(jni);
+
+            const auto ref = static_cast<jclass>(wrapper::add_global_ref(jni, klass));
+
+            this->klass = std::shared_ptr<std::remove_pointer_t<jclass>>(ref, [](const jclass owner) {
+                /*
+                 * Once the VM is gone its references are gone with it.
+                 */
+                if (thread_env::get_vm() != nullptr)
+                {
+                    wrapper::remove_global_ref(thread_env::get(), owner);
+                }
+            });
+        }
+
+        [[nodiscard]] jclass get() const
+        {
+            return klass.get();
+        }
+
+        [[nodiscard]] long use_count() const
+        {
+            return klass.use_count();
+        }
+
+        explicit operator bool() const
+        {
+            return klass != nullptr;
+        }
+    };
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <array>
+#include <jni.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "ZNBKit/internal/util.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jni/signatures/class_handle.hpp"
+#include "ZNBKit/jni/signatures/klass_signature.hpp"
+
+namespace znb_kit
+{
+    /*
+     * JNI accessors and the default descriptor for each supported field type. std::string maps to java.lang.String
+     * and is copied out (null reads as empty); jobject defaults to java.lang.Object and returns a local ref the caller owns.
+     */
+    template <typename T>
+    struct field_traits;
+
+#define FIELD_TRAITS(TYPE, NAME, DESCRIPTOR) \
+    template <> \
+    struct field_traits<TYPE> \
+    { \
+        static constexpr std::string_view descriptor = DESCRIPTOR; \
+        static TYPE get(JNIEnv *jni, const jobject instance, const jfieldID field) { return jni->Get##NAME##Field(instance, field); } \
+        static TYPE get_static(JNIEnv *jni, const jclass klass, const jfieldID field) { return jni->GetStatic##NAME##Field(klass, field); } \
+        static void set(JNIEnv *jni, const jobject instance, const jfieldID field, const TYPE value) { jni->Set##NAME##Field(instance, field, value); } \
+        static void set_static(JNIEnv *jni, const jclass klass, const jfieldID field, const TYPE value) { jni->SetStatic##NAME##Field(klass, field, value); } \
+    };
+
+    FIELD_TRAITS(jboolean, Boolean, "Z")
+    FIELD_TRAITS(jbyte, Byte, "B")
+    FIELD_TRAITS(jchar, Char, "C")
+    FIELD_TRAITS(jshort, Short, "S")
+    FIELD_TRAITS(jint, Int, "I")
+    FIELD_TRAITS(jlong, Long, "J")
+    FIELD_TRAITS(jfloat, Float, "F")
+    FIELD_TRAITS(jdouble, Double, "D")
+    FIELD_TRAITS(jobject, Object, "Ljava/lang/Object;")
+
+#undef FIELD_TRAITS
+
+    template <>
+    struct field_traits<std::string>
+    {
+        static constexpr std::string_view descriptor = "Ljava/lang/String;";
+
+        static std::string to_string(JNIEnv *jni, const jobject value)
+        {
+            if (value == nullptr)
+            {
+                return {};
+            }
+
+            auto result = get_string(jni, static_cast<jstring>(value));
+            jni->DeleteLocalRef(value);
+
+            return result;
+        }
+
+        static std::string get(JNIEnv *jni, const jobject instance, const jfieldID field)
+        {
+            return to_string(jni, jni->GetObjectField(instance, field));
+        }
+
+        static std::string get_static(JNIEnv *jni, const jclass klass, const jfieldID field)
+        {
+            return to_string(jni, jni->GetStaticObjectField(klass, field));
+        }
+
+        static void set(JNIEnv *jni, const jobject instance, const jfieldID field, const std::string &value)
+        {
+            const auto string = jni->NewStringUTF(value.c_str());
+            EXCEPT_CHECK(jni);
+
+            jni->SetObjectField(instance, field, string);
+            jni->DeleteLocalRef(string);
+        }
+
+        static void set_static(JNIEnv *jni, const jclass klass, const jfieldID field, const std::string &value)
+        {
+            const auto string = jni->NewStringUTF(value.c_str());
+            EXCEPT_CHECK(jni);
+
+            jni->SetStaticObjectField(klass, field, string);
+            jni->DeleteLocalRef(string);
+        }
+    };
+
+    /*
+     * Resolved field, the counterpart of method_signature. The jfieldID is looked up once and the class is held
+     * through a shared class_handle, so a field can be kept in a static table and used with any thread's env.
+     */
+    template <typename T>
+    class field_signature
+    {
+        class_handle owner;
+        jfieldID identity;
+
+        bool is_static;
+
+        struct constant_cache
+        {
+            std::once_flag once;
+            T value{};
+        };
+
+        std::unique_ptr<constant_cache> constant = std::make_unique<constant_cache>();
+
+    public:
+        const std::string name;
+        const std::string descriptor;
+
+        field_signature(JNIEnv *jni, const klass_signature &owner, std::string name, const bool is_static = false,
+                        std::string descriptor = std::string(field_traits<T>::descriptor))
+            : owner(owner.get_handle()),
+              is_static(is_static),
+              name(std::move(name)),
+              descriptor(std::move(descriptor))
+        {
+            identity = wrapper::get_field(jni, this->owner.get(), this->name, this->descriptor, is_static);
+        }
+
+        field_signature(const field_signature &) = delete;
+        field_signature &operator=(const field_signature &) = delete;
+
+        field_signature(field_signature &&) noexcept = default;
+
+        [[nodiscard]] T get(JNIEnv *jni, const jobject &instance) const
+        {
+            if (is_static)
+            {
+                return field_traits<T>::get_static(jni, owner.get(), identity);
+            }
+
+            VAR_CHECK(instance);
+            return field_traits<T>::get(jni, instance, identity);
+        }
+
+        void set(JNIEnv *jni, const jobject &instance, const T &value) const
+        {
+            if (is_static)
+            {
+                field_traits<T>::set_static(jni, owner.get(), identity, value);
+                return;
+            }
+
+            VAR_CHECK(instance);
+            field_traits<T>::set(jni, instance, identity, value);
+        }
+
+        /*
+         * Reads a static final field once and serves the cached value afterwards.
+         */
+        [[nodiscard]] const T &get_constant(JNIEnv *jni) const
+        {
+            static_assert(!std::is_same_v<T, jobject>, "Object constants would need a global ref, read them with get()");
+
+            if (!is_static)
+            {
+                throw std::logic_error("Only static fields can be cached as constants: " + name);
+            }
+
+            std::call_once(constant->once, [&] {
+                constant->value = field_traits<T>::get_static(jni, owner.get(), identity);
+            });
+
+            return constant->value;
+        }
+
+        [[nodiscard]] jclass get_owner() const
+        {
+            return owner.get();
+        }
+
+        [[nodiscard]] jfieldID get_identity() const
+        {
+            return identity;
+        }
+    };
+
+    template <typename>
+    struct member_traits;
+
+    template <typename C, typename V>
+    struct member_traits<V C::*>
+    {
+        using owner = C;
+        using value = V;
+    };
+
+    /*
+     * Binds an aggregate member to a Java field name. The descriptor follows from the member type unless given.
+     */
+    template <auto Member>
+    struct field_binding
+    {
+        using value = typename member_traits<decltype(Member)>::value;
+
+        std::string_view name;
+        std::string_view descriptor = field_traits<value>::descriptor;
+    };
+
+    template <auto Member>
+    constexpr field_binding<Member> bind(const std::string_view name)
+    {
+        return {name};
+    }
+
+    template <auto Member>
+    constexpr field_binding<Member> bind(const std::string_view name, const std::string_view descriptor)
+    {
+        return {name, descriptor};
+    }
+
+    /*
+     * Prepared plan mapping an aggregate S onto the fields of one Java class: field IDs are resolved once in the
+     * constructor, and read()/write() then move every bound member with a single Get/Set call each.
+     */
+    template <typename S, auto... Members>
+    class struct_mapping
+    {
+        static_assert((std::is_same_v<typename member_traits<decltype(Members)>::owner, S> && ...),
+                      "Every bound member has to belong to the mapped aggregate");
+
+        class_handle owner;
+        std::array<jfieldID, sizeof...(Members)> identities{};
+
+        template <size_t... I>
+        void read(JNIEnv *jni, const jobject &instance, S &target, std::index_sequence<I...>) const
+        {
+            ((target.*Members = field_traits<typename member_traits<decltype(Members)>::value>::get(jni, instance, identities[I])), ...);
+        }
+
+        template <size_t... I>
+        void write(JNIEnv *jni, const jobject &instance, const S &source, std::index_sequence<I...>) const
+        {
+            (field_traits<typename member_traits<decltype(Members)>::value>::set(jni, instance, identities[I], source.*Members), ...);
+        }
+
+    public:
+        struct_mapping(JNIEnv *jni, const klass_signature &owner, const field_binding<Members> &... bindings): owner(owner.get_handle())
+        {
+            size_t i = 0;
+
+            ((identities[i++] = wrapper::get_field(jni, this->owner.get(), std::string(bindings.name), std::string(bindings.descriptor), false)), ...);
+        }
+
+        [[nodiscard]] S read(JNIEnv *jni, const jobject &instance) const
+        {
+            S target{};
+            read(jni, instance, target);
+
+            return target;
+        }
+
+        void read(JNIEnv *jni, const jobject &instance, S &target) const
+        {
+            VAR_CHECK(instance);
+            read(jni, instance, target, std::index_sequence_for<decltype(Members)...>{});
+        }
+
+        void write(JNIEnv *jni, const jobject &instance, const S &source) const
+        {
+            VAR_CHECK(instance);
+            write(jni, instance, source, std::index_sequence_for<decltype(Members)...>{});
+        }
+
+        [[nodiscard]] jclass get_owner() const
+        {
+            return owner.get();
+        }
+    };
+
+    template <typename S, auto... Members>
+    struct_mapping<S, Members...> make_struct_mapping(JNIEnv *jni, const klass_signature &owner, const field_binding<Members> &... bindings)
+    {
+        return struct_mapping<S, Members...>(jni, owner, bindings...);
+    }
+}
@@ -7,69 +7,50 @@
 #include <jni.h>
 #include <string>
 
+#include "ZNBKit/internal/timeline.hpp"
 #include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jni/signatures/class_handle.hpp"
 
 namespace znb_kit
 {
     class klass_signature
     {
-        JNIEnv *jni;
-        jclass owner;
+        class_handle owner;
 
-        const std::string klass_name;
+        std::string klass_name;
     public:
-        klass_signature(JNIEnv *jni, const std::string &klass_name): jni(jni), klass_name(klass_name)
+        klass_signature(JNIEnv *jni, const std::string &klass_name): klass_name(klass_name)
         {
+            timeline::scope phase("klass_signature", klass_name);
+
             const auto klass = wrapper::search_for_class(jni, klass_name);
-            owner = reinterpret_cast<jclass>(wrapper::add_global_ref(jni, klass));
+            owner = class_handle(jni, klass);
             wrapper::remove_local_ref(jni, klass);
         }
 
-        klass_signature(JNIEnv *jni, const jclass &owner)
+        klass_signature(JNIEnv *jni, const jclass &owner): owner(jni, owner)
         {
-            VAR_CHECK(jni);
-            VAR_CHECK(owner);
-
-            this->jni = jni;
-            this->owner = reinterpret_cast<jclass>(wrapper::add_global_ref(jni, owner));
         }
 
-        ~klass_signature()
-        {
-            if (owner != nullptr && jni != nullptr)
-            {
-                wrapper::remove_global_ref(jni, owner);
-                owner = nullptr;
-            }
-        }
+        /*
+         * Copies share the class handle, so they don't create global refs of their own.
+         */
+        klass_signature(const klass_signature &other) = default;
+        klass_signature &operator=(const klass_signature &other) = default;
 
-        klass_signature(const klass_signature& other) : jni(other.jni) {
-            if (other.owner) {
-                owner = reinterpret_cast<jclass>(wrapper::add_global_ref(jni, other.owner));
-            } else {
-                owner = nullptr;
-            }
+        [[nodiscard]] jclass get_owner() const
+        {
+            return owner.get();
         }
 
-        klass_signature& operator=(const klass_signature& other) {
-            if (this != &other) {
-                if (owner && jni) {
-                    wrapper::remove_global_ref(jni, owner);
-                }
-
-                jni = other.jni;
-                if (other.owner) {
-                    owner = reinterpret_cast<jclass>(wrapper::add_global_ref(jni, other.owner));
-                } else {
-                    owner = nullptr;
-                }
-            }
-            return *this;
+        [[nodiscard]] const class_handle &get_handle() const
+        {
+            return owner;
         }
 
-        [[nodiscard]] jclass get_owner() const
+        [[nodiscard]] const std::string &get_name() const
         {
-            return owner;
+            return klass_name;
         }
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <expected>
+#include <jni.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ZNBKit/internal/thread_env.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jni/signatures/class_handle.hpp"
+#include "ZNBKit/jni/signatures/method_signature.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Resolved method that is not tied to any JNIEnv: it keeps only a shared handle to the declaring class and the
+     * jmethodID, both valid on every thread, and looks up the env of the calling thread on each invoke. A handle is
+     * immutable after construction, so it can sit in a static table and be invoked from any number of threads.
+     */
+    template <typename T>
+    class method_handle
+    {
+        static_assert(std::is_void_v<T> || std::is_convertible_v<T, jobject> ||
+                      std::is_same_v<T, jint> || std::is_same_v<T, jlong> || std::is_same_v<T, jbyte> ||
+                      std::is_same_v<T, jshort> || std::is_same_v<T, jfloat> || std::is_same_v<T, jdouble>,
+                      "method_handle supports void, object, int, long, byte, short, float and double methods");
+
+        class_handle owner;
+        jmethodID identity = nullptr;
+
+        bool is_static = false;
+
+        std::string name;
+        std::string signature;
+
+    public:
+        method_handle(JNIEnv *jni, const jclass &klass, std::string name, std::string signature, const bool is_static)
+            : is_static(is_static), name(std::move(name)), signature(std::move(signature))
+        {
+            VAR_CHECK(jni);
+            VAR_CHECK(klass);
+
+            identity = wrapper::get_method(jni, klass, this->name, this->signature, is_static);
+            owner = class_handle(jni, klass);
+        }
+
+        method_handle(JNIEnv *jni, const std::string &klass_name, std::string name, std::string signature, const bool is_static)
+            : is_static(is_static), name(std::move(name)), signature(std::move(signature))
+        {
+            const auto klass = wrapper::search_for_class(jni, klass_name);
+
+            try
+            {
+                identity = wrapper::get_method(jni, klass, this->name, this->signature, is_static);
+            }
+            catch (...)
+            {
+                wrapper::remove_local_ref(jni, klass);
+                throw;
+            }
+
+            owner = class_handle(jni, klass);
+            wrapper::remove_local_ref(jni, klass);
+        }
+
+        /*
+         * Takes over an already resolved method_signature without resolving it again.
+         */
+        template <typename U>
+        explicit method_handle(const method_signature<U> &method)
+            : owner(method.get_klass().get_handle()),
+              identity(method.get_identity()),
+              is_static(method.is_static_method()),
+              name(method.name),
+              signature(method.signature)
+        {
+        }
+
+        T invoke(const jobject &instance, const std::vector<jvalue> &parameters) const
+        {
+            return invoke(thread_env::get(), instance, parameters);
+        }
+
+        T invoke(JNIEnv *jni, const jobject &instance, const std::vector<jvalue> &parameters) const
+        {
+            const jclass klass = is_static ? owner.get() : nullptr;
+
+            if constexpr (std::is_void_v<T>)
+            {
+                wrapper::invoke_void_method(jni, klass, instance, identity, parameters);
+            }
+            else if constexpr (std::is_convertible_v<T, jobject>)
+            {
+                return static_cast<T>(wrapper::invoke_object_method(jni, klass, instance, identity, parameters));
+            }
+            else if constexpr (std::is_same_v<T, jint>)
+            {
+                return wrapper::invoke_int_method(jni, klass, instance, identity, parameters);
+            }
+            else if constexpr (std::is_same_v<T, jlong>)
+            {
+                return wrapper::invoke_long_method(jni, klass, instance, identity, parameters);
+            }
+            else if constexpr (std::is_same_v<T, jbyte>)
+            {
+                return wrapper::invoke_byte_method(jni, klass, instance, identity, parameters);
+            }
+            else if constexpr (std::is_same_v<T, jshort>)
+            {
+                return wrapper::invoke_short_method(jni, klass, instance, identity, parameters);
+            }
+            else if constexpr (std::is_same_v<T, jfloat>)
+            {
+                return wrapper::invoke_float_method(jni, klass, instance, identity, parameters);
+            }
+            else
+            {
+                return wrapper::invoke_double_method(jni, klass, instance, identity, parameters);
+            }
+        }
+
+        /*
+         * Non-throwing variant; a Java exception is returned as java_error instead of being described and rethrown.
+         */
+        std::expected<T, java_error> try_invoke(const jobject &instance, const std::vector<jvalue> &parameters) const
+        {
+            return try_invoke(thread_env::get(), instance, parameters);
+        }
+
+        std::expected<T, java_error> try_invoke(JNIEnv *jni, const jobject &instance, const std::vector<jvalue> &parameters) const
+        {
+            return wrapper::try_invoke<T>(jni, is_static ? owner.get() : nullptr, instance, identity, parameters);
+        }
+
+        [[nodiscard]] jclass get_owner() const
+        {
+            return owner.get();
+        }
+
+        [[nodiscard]] jmethodID get_identity() const
+        {
+            return identity;
+        }
+
+        [[nodiscard]] bool is_static_method() const
+        {
+            return is_static;
+        }
+
+        [[nodiscard]] const std::string &get_name() const
+        {
+            return name;
+        }
+
+        [[nodiscard]] const std::string &get_signature() const
+        {
+            return signature;
+        }
+    };
+}
@@ -101,9 +101,19 @@ namespace znb_kit
             return owner.get_owner();
         }
 
+        [[nodiscard]] const klass_signature &get_klass() const
+        {
+            return owner;
+        }
+
         [[nodiscard]] jmethodID get_identity() const
         {
             return identity;
         }
+
+        [[nodiscard]] bool is_static_method() const
+        {
+            return is_static;
+        }
     };
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <jni.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace znb_kit
+{
+    /*
+     * Native memory for buffer-heavy paths, handed to Java as direct ByteBuffers whose lifetime is explicit rather
+     * than tied to GC and Cleaner.
+     *
+     * Requests up to 1 MiB are served from power-of-two size classes starting at 64 bytes. Each class carves blocks
+     * out of slabs mapped `slab_size` at a time (aligned to their size, optionally huge-page backed on Linux); larger
+     * requests get a mapping of their own. Every thread keeps a small cache of free blocks per class, so the class
+     * lock is only taken to refill or flush half a cache at a time.
+     *
+     * A block is identified by a 64-bit handle: [8 bits class + 1][24 bits slab][32 bits block], class 0xFF marking a
+     * dedicated mapping. 0 is never a valid handle. A per-slab bitmap of live blocks catches double and foreign frees.
+     */
+    class slab_allocator
+    {
+    public:
+        enum huge_page_mode : uint8_t
+        {
+            NO_HUGE_PAGES,
+
+            /*
+             * madvise(MADV_HUGEPAGE) on every slab, leaving promotion to the kernel.
+             */
+            TRANSPARENT_HUGE_PAGES,
+
+            /*
+             * MAP_HUGETLB from the reserved pool, falling back to regular pages when the pool is exhausted.
+             */
+            EXPLICIT_HUGE_PAGES,
+        };
+
+        static constexpr size_t MIN_BLOCK = 64;
+        static constexpr size_t MAX_BLOCK = size_t{1} << 20;
+        static constexpr size_t CLASS_COUNT = 15;
+
+        struct options
+        {
+            /*
+             * Rounded up to a power of two, at least 2 MiB.
+             */
+            size_t slab_size = size_t{2} << 20;
+            size_t max_slabs = 4096;
+
+            huge_page_mode huge_pages = NO_HUGE_PAGES;
+
+            /*
+             * Free blocks a thread keeps per size class; 0 sends every call to the shared free lists.
+             */
+            size_t thread_cache = 64;
+        };
+
+        struct slice
+        {
+            uint64_t handle = 0;
+            std::span<std::byte> memory;
+        };
+
+        struct class_stats
+        {
+            size_t block_size = 0;
+            size_t slabs = 0;
+            size_t blocks = 0;
+            size_t in_use = 0;
+        };
+
+        struct stats
+        {
+            size_t reserved_bytes = 0;
+            size_t in_use_bytes = 0;
+            size_t slabs = 0;
+            size_t huge_page_slabs = 0;
+            size_t huge_page_fallbacks = 0;
+            size_t large_allocations = 0;
+            size_t large_bytes = 0;
+
+            std::vector<class_stats> classes;
+
+            [[nodiscard]] std::string to_json() const;
+        };
+
+        explicit slab_allocator(const options &options);
+
+        slab_allocator(const slab_allocator &) = delete;
+        slab_allocator &operator=(const slab_allocator &) = delete;
+
+        /*
+         * Unmaps everything, live slices included; Java must not touch its buffers afterwards.
+         */
+        ~slab_allocator();
+
+        /*
+         * Throws std::bad_alloc when no memory can be mapped or max_slabs is reached.
+         */
+        slice allocate(size_t size);
+
+        /*
+         * Throws std::invalid_argument for handles that are not live in this allocator.
+         */
+        void free(uint64_t handle);
+
+        /*
+         * Frees every live handle and skips the rest. Returns how many were freed.
+         */
+        size_t free_bulk(std::span<const uint64_t> handles);
+
+        /*
+         * Memory behind a live handle. For size-class blocks this is the whole block, which can exceed the request.
+         */
+        [[nodiscard]] std::span<std::byte> get(uint64_t handle) const;
+
+        /*
+         * Allocates `size` bytes and returns them as a direct ByteBuffer of exactly that capacity.
+         */
+        jobject allocate_java(JNIEnv *env, size_t size);
+
+        /*
+         * Handle behind a buffer returned by allocate_java().
+         */
+        uint64_t handle_of(JNIEnv *env, const jobject &byte_buffer) const;
+
+        size_t free_bulk(JNIEnv *env, const jlongArray &handles);
+
+        [[nodiscard]] stats get_stats() const;
+
+        struct state;
+
+    private:
+        std::shared_ptr<state> shared;
+    };
+}
@@ -36,6 +36,24 @@ int znb_kit::buffer::get_ptr_byte(JNIEnv *env, const jbyteArray &buffer, int8_t
     return buffer_length;
 }
 
+std::span<std::byte> znb_kit::buffer::get_direct(JNIEnv *env, const jobject &byte_buffer)
+{
+    if (byte_buffer == nullptr)
+    {
+        throw std::invalid_argument("buffer is null");
+    }
+
+    auto *address = static_cast<std::byte *>(env->GetDirectBufferAddress(byte_buffer));
+    const auto capacity = env->GetDirectBufferCapacity(byte_buffer);
+
+    if (address == nullptr || capacity < 0)
+    {
+        throw std::invalid_argument("buffer is not a direct ByteBuffer");
+    }
+
+    return {address, static_cast<size_t>(capacity)};
+}
+
 int znb_kit::buffer::get_length(JNIEnv *env, const jarray &buffer, const int array_length, const int buffer_offset)
 {
     if (buffer == nullptr)
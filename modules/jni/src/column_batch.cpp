@@ -0,0 +1,405 @@
+#include "ZNBKit/jni/column_batch.hpp"
+
+#include <format>
+
+#include "ZNBKit/internal/local_ref.hpp"
+#include "ZNBKit/internal/util.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jni/buffer.hpp"
+
+namespace
+{
+    constexpr size_t BUFFERS_PER_COLUMN = 3;
+
+    std::string_view get_column_type_name(const znb_kit::column_type type)
+    {
+        switch (type)
+        {
+        case znb_kit::INT8:
+            return "int8";
+        case znb_kit::INT16:
+            return "int16";
+        case znb_kit::INT32:
+            return "int32";
+        case znb_kit::INT64:
+            return "int64";
+        case znb_kit::FLOAT32:
+            return "float32";
+        case znb_kit::FLOAT64:
+            return "float64";
+        case znb_kit::UTF8:
+            return "utf8";
+        }
+
+        return "unknown";
+    }
+
+    /*
+     * NewDirectByteBuffer wants a real address even for an empty buffer, which an empty std::vector does not have.
+     */
+    jobject new_direct(JNIEnv *env, const void *address, const size_t size)
+    {
+        static std::byte empty{};
+
+        const auto view = env->NewDirectByteBuffer(size == 0 ? &empty : const_cast<void *>(address), static_cast<jlong>(size));
+
+        EXCEPT_CHECK(env);
+
+        if (view == nullptr)
+        {
+            throw std::runtime_error("NewDirectByteBuffer failed, direct buffer access is not supported by this VM");
+        }
+
+        return view;
+    }
+}
+
+namespace znb_kit
+{
+    size_t get_column_width(const column_type type)
+    {
+        switch (type)
+        {
+        case INT8:
+            return 1;
+        case INT16:
+            return 2;
+        case INT32:
+        case FLOAT32:
+            return 4;
+        case INT64:
+        case FLOAT64:
+            return 8;
+        case UTF8:
+            return 0;
+        }
+
+        throw std::invalid_argument("Unknown column type");
+    }
+
+    size_t column_view::null_count() const
+    {
+        if (validity == nullptr)
+        {
+            return 0;
+        }
+
+        size_t valid = 0;
+        size_t row = 0;
+
+        for (; row + 64 <= length; row += 64)
+        {
+            uint64_t word;
+            std::memcpy(&word, validity + row / 8, sizeof(word));
+            valid += std::popcount(word);
+        }
+
+        for (; row < length; ++row)
+        {
+            valid += is_valid(row);
+        }
+
+        return length - valid;
+    }
+
+    column_batch::column_batch(std::vector<column_spec> schema, const size_t capacity) : schema(std::move(schema))
+    {
+        columns.resize(this->schema.size());
+
+        for (size_t i = 0; i < this->schema.size(); ++i)
+        {
+            const auto &spec = this->schema[i];
+            auto &column = columns[i];
+
+            if (spec.name.empty())
+            {
+                throw std::invalid_argument("Column name is empty");
+            }
+
+            if (spec.nullable)
+            {
+                column.validity.reserve((capacity + 7) / 8);
+            }
+
+            if (spec.type == UTF8)
+            {
+                column.offsets.reserve(capacity + 1);
+                column.offsets.push_back(0);
+            }
+            else
+            {
+                column.values.reserve(capacity * get_column_width(spec.type));
+            }
+        }
+    }
+
+    column_batch::column &column_batch::get_column(const size_t index, const column_type type)
+    {
+        if (index >= columns.size())
+        {
+            throw std::out_of_range("Column index " + std::to_string(index) + " is out of range");
+        }
+
+        if (schema[index].type != type)
+        {
+            throw std::invalid_argument("Value type does not match column '" + schema[index].name + "'");
+        }
+
+        return columns[index];
+    }
+
+    void column_batch::mark(const size_t index, const bool valid)
+    {
+        auto &column = columns[index];
+
+        if (schema[index].nullable)
+        {
+            if (column.length % 8 == 0)
+            {
+                column.validity.push_back(0);
+            }
+
+            if (valid)
+            {
+                column.validity.back() |= static_cast<uint8_t>(1u << (column.length % 8));
+            }
+        }
+
+        ++column.length;
+    }
+
+    void column_batch::append(const size_t index, const std::string_view value)
+    {
+        auto &column = get_column(index, UTF8);
+
+        if (column.data.size() + value.size() > INT32_MAX)
+        {
+            throw std::length_error("String column '" + schema[index].name + "' exceeds 2 GiB of data");
+        }
+
+        column.data.insert(column.data.end(), value.begin(), value.end());
+        column.offsets.push_back(static_cast<int32_t>(column.data.size()));
+
+        mark(index, true);
+    }
+
+    void column_batch::append_null(const size_t index)
+    {
+        if (index >= columns.size())
+        {
+            throw std::out_of_range("Column index " + std::to_string(index) + " is out of range");
+        }
+
+        if (!schema[index].nullable)
+        {
+            throw std::invalid_argument("Column '" + schema[index].name + "' is not nullable");
+        }
+
+        auto &column = columns[index];
+
+        if (schema[index].type == UTF8)
+        {
+            column.offsets.push_back(column.offsets.back());
+        }
+        else
+        {
+            column.values.resize(column.values.size() + get_column_width(schema[index].type));
+        }
+
+        mark(index, false);
+    }
+
+    size_t column_batch::rows() const
+    {
+        if (columns.empty())
+        {
+            return 0;
+        }
+
+        const size_t length = columns.front().length;
+
+        for (size_t i = 1; i < columns.size(); ++i)
+        {
+            if (columns[i].length != length)
+            {
+                throw std::logic_error(std::format("Column '{}' has {} rows while '{}' has {}",
+                    schema[i].name, columns[i].length, schema.front().name, length));
+            }
+        }
+
+        return length;
+    }
+
+    column_view column_batch::view(const size_t index) const
+    {
+        const auto &column = columns.at(index);
+        const bool strings = schema[index].type == UTF8;
+
+        return {
+            schema[index].type,
+            column.length,
+            schema[index].nullable ? column.validity.data() : nullptr,
+            strings ? nullptr : column.values.data(),
+            strings ? column.offsets.data() : nullptr,
+            strings ? column.data.data() : nullptr
+        };
+    }
+
+    void column_batch::clear()
+    {
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            auto &column = columns[i];
+
+            column.validity.clear();
+            column.values.clear();
+            column.data.clear();
+            column.offsets.clear();
+            column.length = 0;
+
+            if (schema[i].type == UTF8)
+            {
+                column.offsets.push_back(0);
+            }
+        }
+    }
+
+    jobjectArray column_batch::to_java(JNIEnv *env) const
+    {
+        VAR_CHECK(env);
+
+        /*
+         * Ragged columns would hand Java buffers that disagree on the row count.
+         */
+        static_cast<void>(rows());
+
+        const local_class klass(env, env->FindClass("java/nio/ByteBuffer"));
+
+        EXCEPT_CHECK(env);
+
+        const auto array = env->NewObjectArray(static_cast<jsize>(columns.size() * BUFFERS_PER_COLUMN), klass.get(), nullptr);
+
+        EXCEPT_CHECK(env);
+
+        const auto set = [&](const size_t slot, const void *address, const size_t size) {
+            const auto view = new_direct(env, address, size);
+
+            env->SetObjectArrayElement(array, static_cast<jsize>(slot), view);
+            env->DeleteLocalRef(view);
+        };
+
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            const auto &column = columns[i];
+            const size_t slot = i * BUFFERS_PER_COLUMN;
+
+            if (schema[i].nullable)
+            {
+                set(slot, column.validity.data(), column.validity.size());
+            }
+
+            if (schema[i].type == UTF8)
+            {
+                set(slot + 1, column.offsets.data(), column.offsets.size() * sizeof(int32_t));
+                set(slot + 2, column.data.data(), column.data.size());
+            }
+            else
+            {
+                set(slot + 1, column.values.data(), column.values.size());
+            }
+        }
+
+        return array;
+    }
+
+    std::string column_batch::describe() const
+    {
+        std::string json = std::format("{{\"rows\":{},\"columns\":[", rows());
+
+        for (size_t i = 0; i < schema.size(); ++i)
+        {
+            json += std::format("{}{{\"name\":\"{}\",\"type\":\"{}\",\"nullable\":{}}}",
+                i == 0 ? "" : ",", escape_json(schema[i].name), get_column_type_name(schema[i].type), schema[i].nullable);
+        }
+
+        return json + "]}";
+    }
+
+    column_batch_reader::column_batch_reader(JNIEnv *env, const jobjectArray &buffers, const std::vector<column_spec> &schema, const size_t rows)
+        : row_count(rows)
+    {
+        VAR_CHECK(env);
+        VAR_CHECK(buffers);
+
+        if (static_cast<size_t>(env->GetArrayLength(buffers)) != schema.size() * BUFFERS_PER_COLUMN)
+        {
+            throw std::invalid_argument("Buffer array does not match the schema");
+        }
+
+        const auto get = [&](const size_t slot, const size_t required, const bool optional) -> const std::byte * {
+            const local_object element(env, env->GetObjectArrayElement(buffers, static_cast<jsize>(slot)));
+
+            EXCEPT_CHECK(env);
+
+            if (!element)
+            {
+                if (!optional)
+                {
+                    throw std::invalid_argument("Required column buffer " + std::to_string(slot) + " is null");
+                }
+
+                return nullptr;
+            }
+
+            const auto data = buffer::get_direct(env, element.get());
+
+            if (data.size() < required)
+            {
+                throw std::out_of_range(std::format("Column buffer {} holds {} bytes, {} required", slot, data.size(), required));
+            }
+
+            /*
+             * The address outlives the local ref, the ByteBuffer itself is what keeps the memory alive.
+             */
+            return data.data();
+        };
+
+        columns.reserve(schema.size());
+
+        for (size_t i = 0; i < schema.size(); ++i)
+        {
+            const auto &spec = schema[i];
+            const size_t slot = i * BUFFERS_PER_COLUMN;
+
+            /*
+             * to_java() leaves the validity slot of a non-nullable column empty, so only its presence is checked here.
+             */
+            const auto *validity = reinterpret_cast<const uint8_t *>(get(slot, (rows + 7) / 8, true));
+
+            if (!spec.nullable && validity != nullptr)
+            {
+                throw std::invalid_argument("Column '" + spec.name + "' is not nullable but has a validity buffer");
+            }
+
+            if (spec.type != UTF8)
+            {
+                columns.emplace_back(spec.type, rows, validity, get(slot + 1, rows * get_column_width(spec.type), false), nullptr, nullptr);
+                continue;
+            }
+
+            const auto *offsets = reinterpret_cast<const int32_t *>(get(slot + 1, (rows + 1) * sizeof(int32_t), false));
+
+            for (size_t row = 0; row < rows; ++row)
+            {
+                if (offsets[row] < 0 || offsets[row + 1] < offsets[row])
+                {
+                    throw std::invalid_argument("String column '" + spec.name + "' has non-monotonic offsets");
+                }
+            }
+
+            const auto *data = reinterpret_cast<const char *>(get(slot + 2, static_cast<size_t>(offsets[rows]), false));
+
+            columns.emplace_back(spec.type, rows, validity, nullptr, offsets, data);
+        }
+    }
+}
@@ -0,0 +1,382 @@
+#include "ZNBKit/jni/mapped_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jni/buffer.hpp"
+
+namespace
+{
+    struct pin
+    {
+        jweak view;
+        std::shared_ptr<znb_kit::mapped_file> file;
+    };
+
+    constexpr size_t MIN_SWEEP_THRESHOLD = 64;
+
+    std::mutex pins_mutex;
+    std::unordered_multimap<const std::byte *, pin> pins;
+    size_t sweep_threshold = MIN_SWEEP_THRESHOLD;
+
+    /*
+     * Caller holds pins_mutex. The files come back so a mapping whose last owner was a pin is unmapped outside the lock.
+     */
+    std::vector<std::shared_ptr<znb_kit::mapped_file>> sweep_pins(JNIEnv *env)
+    {
+        std::vector<std::shared_ptr<znb_kit::mapped_file>> released;
+
+        for (auto it = pins.begin(); it != pins.end();)
+        {
+            if (!znb_kit::wrapper::is_cleared(env, it->second.view))
+            {
+                ++it;
+                continue;
+            }
+
+            znb_kit::wrapper::remove_weak_ref(env, it->second.view);
+            released.push_back(std::move(it->second.file));
+
+            it = pins.erase(it);
+        }
+
+        sweep_threshold = std::max(MIN_SWEEP_THRESHOLD, pins.size() * 2);
+
+        return released;
+    }
+
+    std::string get_error(const std::string &action, const std::filesystem::path &path)
+    {
+        return "Failed to " + action + " '" + path.string() + "': " + std::strerror(errno);
+    }
+
+    int get_advice(const znb_kit::mapped_file::advice hint)
+    {
+        switch (hint)
+        {
+        case znb_kit::mapped_file::SEQUENTIAL:
+            return MADV_SEQUENTIAL;
+        case znb_kit::mapped_file::RANDOM:
+            return MADV_RANDOM;
+        case znb_kit::mapped_file::WILL_NEED:
+            return MADV_WILLNEED;
+        case znb_kit::mapped_file::DONT_NEED:
+            return MADV_DONTNEED;
+        case znb_kit::mapped_file::NORMAL:
+            break;
+        }
+
+        return MADV_NORMAL;
+    }
+
+    /*
+     * madvise and msync want page-aligned addresses, so ranges are widened down to the page they start in.
+     */
+    std::span<std::byte> align_to_pages(const std::span<std::byte> range)
+    {
+        static const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+        const auto start = reinterpret_cast<uintptr_t>(range.data());
+        const auto aligned = start & ~(page_size - 1);
+
+        return {reinterpret_cast<std::byte *>(aligned), range.size() + (start - aligned)};
+    }
+}
+
+namespace znb_kit
+{
+    mapped_file::mapped_file(std::filesystem::path path, const access_mode access, std::byte *data, const size_t length)
+        : path(std::move(path)), access(access), data(data), length(length)
+    {
+    }
+
+    mapped_file::~mapped_file()
+    {
+        if (data != nullptr)
+        {
+            munmap(data, length);
+        }
+    }
+
+    std::shared_ptr<mapped_file> mapped_file::open(const std::filesystem::path &path)
+    {
+        return open(path, options{});
+    }
+
+    std::shared_ptr<mapped_file> mapped_file::open(const std::filesystem::path &path, const options &options)
+    {
+        if (options.size && options.access != READ_WRITE)
+        {
+            throw std::invalid_argument("Only read-write mappings can resize their file");
+        }
+
+        int flags = options.access == READ_WRITE ? O_RDWR : O_RDONLY;
+
+        if (options.size)
+        {
+            flags |= O_CREAT;
+        }
+
+        const int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+
+        if (fd < 0)
+        {
+            throw std::runtime_error(get_error("open", path));
+        }
+
+        /*
+         * The mapping keeps its own reference to the file, the descriptor is not needed past mmap.
+         */
+        struct fd_guard
+        {
+            int fd;
+
+            ~fd_guard()
+            {
+                close(fd);
+            }
+        } guard{fd};
+
+        if (options.size && ftruncate(fd, static_cast<off_t>(*options.size)) != 0)
+        {
+            throw std::runtime_error(get_error("resize", path));
+        }
+
+        struct stat status{};
+
+        if (fstat(fd, &status) != 0)
+        {
+            throw std::runtime_error(get_error("stat", path));
+        }
+
+        const auto length = static_cast<size_t>(status.st_size);
+
+        if (length == 0)
+        {
+            return std::shared_ptr<mapped_file>(new mapped_file(path, options.access, nullptr, 0));
+        }
+
+        const int protection = options.access == READ_WRITE ? PROT_READ | PROT_WRITE : PROT_READ;
+        int mapping = MAP_SHARED;
+
+#ifdef MAP_POPULATE
+        if (options.populate)
+        {
+            mapping |= MAP_POPULATE;
+        }
+#endif
+
+        void *address = mmap(nullptr, length, protection, mapping, fd, 0);
+
+        if (address == MAP_FAILED)
+        {
+            throw std::runtime_error(get_error("map", path));
+        }
+
+        auto file = std::shared_ptr<mapped_file>(new mapped_file(path, options.access, static_cast<std::byte *>(address), length));
+
+        if (options.hint != NORMAL)
+        {
+            file->advise(options.hint);
+        }
+
+#ifndef MAP_POPULATE
+        if (options.populate)
+        {
+            file->advise(WILL_NEED);
+
+            static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            const volatile auto *pages = file->data;
+
+            for (size_t offset = 0; offset < length; offset += page_size)
+            {
+                static_cast<void>(pages[offset]);
+            }
+        }
+#endif
+
+        return file;
+    }
+
+    std::span<std::byte> mapped_file::get_range(const size_t offset, const std::optional<size_t> count) const
+    {
+        if (offset > length)
+        {
+            throw std::out_of_range("Offset " + std::to_string(offset) + " is past the end of the mapping");
+        }
+
+        const size_t size = count.value_or(length - offset);
+
+        if (size > length - offset)
+        {
+            throw std::out_of_range("Range is outside of the mapping");
+        }
+
+        return {data + offset, size};
+    }
+
+    void mapped_file::advise(const advice hint, const size_t offset, const std::optional<size_t> count) const
+    {
+        const auto range = get_range(offset, count);
+
+        if (range.empty())
+        {
+            return;
+        }
+
+        const auto pages = align_to_pages(range);
+
+        if (madvise(pages.data(), pages.size(), get_advice(hint)) != 0)
+        {
+            throw std::runtime_error(get_error("advise", path));
+        }
+    }
+
+    void mapped_file::sync(const size_t offset, const std::optional<size_t> count, const bool async) const
+    {
+        if (!is_writable())
+        {
+            throw std::logic_error("Read-only mappings have nothing to sync");
+        }
+
+        const auto range = get_range(offset, count);
+
+        if (range.empty())
+        {
+            return;
+        }
+
+        const auto pages = align_to_pages(range);
+
+        if (msync(pages.data(), pages.size(), async ? MS_ASYNC : MS_SYNC) != 0)
+        {
+            throw std::runtime_error(get_error("sync", path));
+        }
+    }
+
+    jobject mapped_file::window(JNIEnv *env, const size_t offset, const std::optional<size_t> count)
+    {
+        VAR_CHECK(env);
+
+        const auto range = get_range(offset, count);
+
+        if (data == nullptr)
+        {
+            throw std::invalid_argument("Cannot open a window on an empty mapping");
+        }
+
+        jobject view = env->NewDirectByteBuffer(range.data(), static_cast<jlong>(range.size()));
+
+        EXCEPT_CHECK(env);
+
+        if (view == nullptr)
+        {
+            throw std::runtime_error("NewDirectByteBuffer failed, direct buffer access is not supported by this VM");
+        }
+
+        if (!is_writable())
+        {
+            const auto method_id = wrapper::get_method(env, "java/nio/ByteBuffer", "asReadOnlyBuffer", "()Ljava/nio/ByteBuffer;", false);
+            const jobject read_only = env->CallObjectMethod(view, method_id);
+
+            env->DeleteLocalRef(view);
+
+            EXCEPT_CHECK(env);
+
+            view = read_only;
+        }
+
+        const auto weak = wrapper::add_weak_ref(env, view);
+
+        windows.fetch_add(1, std::memory_order_relaxed);
+
+        std::vector<std::shared_ptr<mapped_file>> released;
+
+        {
+            std::lock_guard lock(pins_mutex);
+
+            pins.emplace(range.data(), pin{weak, shared_from_this()});
+
+            if (pins.size() >= sweep_threshold)
+            {
+                released = sweep_pins(env);
+            }
+        }
+
+        for (const auto &file : released)
+        {
+            file->windows.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        return view;
+    }
+
+    bool mapped_file::release(JNIEnv *env, const jobject &window)
+    {
+        VAR_CHECK(env);
+
+        const auto range = buffer::get_direct(env, window);
+
+        /*
+         * Moved out so a mapping whose last owner was this pin is unmapped outside the lock.
+         */
+        std::shared_ptr<mapped_file> file;
+
+        {
+            std::lock_guard lock(pins_mutex);
+
+            auto [begin, end] = pins.equal_range(range.data());
+
+            for (auto it = begin; it != end; ++it)
+            {
+                if (env->IsSameObject(it->second.view, window))
+                {
+                    wrapper::remove_weak_ref(env, it->second.view);
+                    file = std::move(it->second.file);
+
+                    pins.erase(it);
+                    break;
+                }
+            }
+        }
+
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        file->windows.fetch_sub(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    size_t mapped_file::sweep(JNIEnv *env)
+    {
+        VAR_CHECK(env);
+
+        std::vector<std::shared_ptr<mapped_file>> released;
+
+        {
+            std::lock_guard lock(pins_mutex);
+            released = sweep_pins(env);
+        }
+
+        for (const auto &file : released)
+        {
+            file->windows.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        return released.size();
+    }
+}
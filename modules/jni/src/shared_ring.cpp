@@ -0,0 +1,402 @@
+#include "ZNBKit/jni/shared_ring.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <format>
+#include <stdexcept>
+#include <thread>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/local_ref.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+
+namespace
+{
+    constexpr size_t PAGE_SIZE = 4096;
+    constexpr size_t MAX_CAPACITY = size_t{1} << 30;
+
+    template <typename T>
+    void store_field(std::byte *memory, const size_t offset, const T value)
+    {
+        std::memcpy(memory + offset, &value, sizeof(T));
+    }
+}
+
+namespace znb_kit
+{
+    void shared_ring::free_deleter::operator()(std::byte *memory) const
+    {
+        std::free(memory);
+    }
+
+    shared_ring::shared_ring(const options &options)
+        : capacity(std::bit_ceil(std::max(options.capacity, PAGE_SIZE))), mask(capacity - 1), producers(options.producers)
+    {
+        if (capacity > MAX_CAPACITY)
+        {
+            throw std::invalid_argument("Ring capacity is limited to 1 GiB");
+        }
+
+        const size_t total = HEADER_SIZE + capacity;
+        auto *raw = static_cast<std::byte *>(std::aligned_alloc(PAGE_SIZE, (total + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1)));
+
+        if (raw == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        std::memset(raw, 0, total);
+
+        memory.reset(raw);
+        data = raw + HEADER_SIZE;
+
+        store_field<uint32_t>(raw, 0, MAGIC);
+        store_field<uint32_t>(raw, 4, VERSION);
+        store_field<uint64_t>(raw, 8, capacity);
+        store_field<uint32_t>(raw, 16, producers);
+    }
+
+    jobject shared_ring::to_java(JNIEnv *env) const
+    {
+        VAR_CHECK(env);
+
+        const auto view = env->NewDirectByteBuffer(memory.get(), static_cast<jlong>(HEADER_SIZE + capacity));
+
+        EXCEPT_CHECK(env);
+
+        if (view == nullptr)
+        {
+            throw std::runtime_error("NewDirectByteBuffer failed, direct buffer access is not supported by this VM");
+        }
+
+        return view;
+    }
+
+    std::string shared_ring::describe() const
+    {
+        return std::format("{{\"capacity\":{},\"producers\":\"{}\",\"header_size\":{},\"tail_offset\":{},\"head_offset\":{},"
+                           "\"waiting_offset\":{},\"record_header\":{},\"record_alignment\":{},\"padding_type\":{},"
+                           "\"byte_order\":\"little\"}}",
+            capacity, producers == SINGLE_PRODUCER ? "single" : "multi", HEADER_SIZE, TAIL_OFFSET, HEAD_OFFSET,
+            WAITING_OFFSET, RECORD_HEADER, RECORD_ALIGNMENT, PADDING);
+    }
+
+    shared_ring::~shared_ring()
+    {
+        stop_waker();
+    }
+
+    void shared_ring::set_consumer(JNIEnv *env, const jobject &thread)
+    {
+        VAR_CHECK(env);
+        VAR_CHECK(thread);
+
+        if (consumer != nullptr)
+        {
+            throw std::logic_error("Ring already has a consumer thread");
+        }
+
+        JavaVM *jvm = nullptr;
+
+        if (env->GetJavaVM(&jvm) != JNI_OK || jvm == nullptr)
+        {
+            throw std::runtime_error("Failed to get the JavaVM of the consumer thread");
+        }
+
+        const local_class klass(env, env->FindClass("java/util/concurrent/locks/LockSupport"));
+
+        EXCEPT_CHECK(env);
+
+        lock_support = class_handle(env, klass.get());
+        unpark = wrapper::get_method(env, lock_support.get(), "unpark", "(Ljava/lang/Thread;)V", true);
+        consumer = wrapper::add_global_ref(env, thread);
+
+        waking.store(true, std::memory_order_relaxed);
+        waker = std::thread(&shared_ring::wake_consumer, this, jvm);
+    }
+
+    void shared_ring::release(JNIEnv *env)
+    {
+        stop_waker();
+
+        if (consumer != nullptr)
+        {
+            wrapper::remove_global_ref(env, consumer);
+            consumer = nullptr;
+        }
+
+        lock_support = {};
+        unpark = nullptr;
+    }
+
+    void shared_ring::stop_waker()
+    {
+        if (!waker.joinable())
+        {
+            return;
+        }
+
+        waking.store(false);
+        wake_pending.store(true);
+        wake_pending.notify_one();
+
+        waker.join();
+    }
+
+    void shared_ring::wake_consumer(JavaVM *vm)
+    {
+        JNIEnv *env = nullptr;
+
+        JavaVMAttachArgs attach_args;
+        attach_args.version = JNI_VERSION_1_8;
+        attach_args.name = const_cast<char *>("znb-ring-waker");
+        attach_args.group = nullptr;
+
+        if (vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void **>(&env), &attach_args) != JNI_OK)
+        {
+            debug_print_cerr("[RING] Unable to attach the waker thread, a parked consumer will not be woken");
+            return;
+        }
+
+        while (true)
+        {
+            wake_pending.wait(false, std::memory_order_acquire);
+
+            /*
+             * Cleared before checking `waking`, both sequentially consistent, so a stop request arriving in between
+             * leaves the flag set and the next wait returns right away.
+             */
+            wake_pending.store(false);
+
+            if (!waking.load())
+            {
+                break;
+            }
+
+            env->CallStaticVoidMethod(lock_support.get(), unpark, consumer);
+
+            if (env->ExceptionCheck())
+            {
+                env->ExceptionClear();
+                failed_wakeups.fetch_add(1, std::memory_order_relaxed);
+
+                continue;
+            }
+
+            wakeups.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        vm->DetachCurrentThread();
+    }
+
+    std::optional<uint64_t> shared_ring::claim(const size_t size)
+    {
+        auto tail_ref = index(TAIL_OFFSET);
+        auto head_ref = index(HEAD_OFFSET);
+
+        uint64_t tail = tail_ref.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            const size_t position = tail & mask;
+            const size_t padding = position + size > capacity ? capacity - position : 0;
+            const size_t required = padding + size;
+
+            uint64_t head = producers == SINGLE_PRODUCER ? cached_head : head_ref.load(std::memory_order_acquire);
+
+            if (required > capacity - (tail - head) && producers == SINGLE_PRODUCER)
+            {
+                cached_head = head = head_ref.load(std::memory_order_acquire);
+            }
+
+            if (required > capacity - (tail - head))
+            {
+                return std::nullopt;
+            }
+
+            if (producers == SINGLE_PRODUCER)
+            {
+                tail_ref.store(tail + required, std::memory_order_relaxed);
+            }
+            else if (!tail_ref.compare_exchange_weak(tail, tail + required, std::memory_order_relaxed))
+            {
+                continue;
+            }
+
+            if (padding != 0)
+            {
+                std::byte *record = data + position;
+
+                write(record, PADDING, {});
+                length_at(record).store(static_cast<int32_t>(padding), std::memory_order_release);
+            }
+
+            return tail + padding;
+        }
+    }
+
+    void shared_ring::write(std::byte *record, const int32_t type, const std::span<const std::byte> payload)
+    {
+        std::memcpy(record + 4, &type, sizeof(type));
+
+        if (!payload.empty())
+        {
+            std::memcpy(record + RECORD_HEADER, payload.data(), payload.size());
+        }
+    }
+
+    bool shared_ring::try_write(const int32_t type, const std::span<const std::byte> payload)
+    {
+        if (payload.size() > capacity - RECORD_HEADER)
+        {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const auto position = claim(align(RECORD_HEADER + payload.size()));
+
+        if (!position)
+        {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        std::byte *record = data + (*position & mask);
+
+        write(record, type, payload);
+        length_at(record).store(static_cast<int32_t>(RECORD_HEADER + payload.size()), std::memory_order_release);
+
+        signal();
+
+        return true;
+    }
+
+    bool shared_ring::try_write_batch(const int32_t type, const std::span<const std::span<const std::byte>> messages)
+    {
+        if (messages.empty())
+        {
+            return true;
+        }
+
+        size_t total = 0;
+
+        for (const auto &message : messages)
+        {
+            total += align(RECORD_HEADER + message.size());
+        }
+
+        const auto position = total <= capacity ? claim(total) : std::nullopt;
+
+        if (!position)
+        {
+            rejected.fetch_add(messages.size(), std::memory_order_relaxed);
+            return false;
+        }
+
+        std::byte *first = data + (*position & mask);
+        std::byte *record = first;
+
+        for (const auto &message : messages)
+        {
+            write(record, type, message);
+
+            /*
+             * Only the first record is published with release: the consumer cannot get past it before it appears, and
+             * acquiring it makes the whole batch visible.
+             */
+            if (record != first)
+            {
+                length_at(record).store(static_cast<int32_t>(RECORD_HEADER + message.size()), std::memory_order_relaxed);
+            }
+
+            record += align(RECORD_HEADER + message.size());
+        }
+
+        length_at(first).store(static_cast<int32_t>(RECORD_HEADER + messages.front().size()), std::memory_order_release);
+
+        signal();
+
+        return true;
+    }
+
+    void shared_ring::signal()
+    {
+        /*
+         * Pairs with the Java consumer storing `waiting` before re-checking head: either it sees the record or we see
+         * the flag.
+         */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (std::atomic_ref(*reinterpret_cast<int32_t *>(memory.get() + WAITING_OFFSET)).load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+
+        /*
+         * Only the first producer to see the consumer waiting pays for the futex wake.
+         */
+        if (!wake_pending.exchange(true, std::memory_order_acq_rel))
+        {
+            wake_pending.notify_one();
+        }
+    }
+
+    bool shared_ring::available() const
+    {
+        const uint64_t head = index(HEAD_OFFSET).load(std::memory_order_acquire);
+        std::byte *record = data + (head & mask);
+
+        const int32_t length = length_at(record).load(std::memory_order_acquire);
+
+        if (length <= 0)
+        {
+            return false;
+        }
+
+        int32_t type;
+        std::memcpy(&type, record + 4, sizeof(type));
+
+        /*
+         * A padding record is published before the record behind it, which then sits at the start of the data.
+         */
+        return type != PADDING || length_at(data).load(std::memory_order_acquire) > 0;
+    }
+
+    bool shared_ring::wait(const std::chrono::nanoseconds timeout) const
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        auto backoff = std::chrono::microseconds(1);
+
+        for (int i = 0; i < 256; ++i)
+        {
+            if (available())
+            {
+                return true;
+            }
+
+            if (i >= 128)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (available())
+            {
+                return true;
+            }
+
+            std::this_thread::sleep_for(backoff);
+            backoff = std::min(backoff * 2, std::chrono::microseconds(1000));
+        }
+
+        return available();
+    }
+
+    size_t shared_ring::size() const
+    {
+        return index(TAIL_OFFSET).load(std::memory_order_acquire) - index(HEAD_OFFSET).load(std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,677 @@
+#include "ZNBKit/jni/slab_allocator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <format>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jni/buffer.hpp"
+
+namespace
+{
+    using znb_kit::slab_allocator;
+
+    constexpr uint64_t LARGE_CLASS = 0xFF;
+    constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+    constexpr size_t MAX_SLABS = size_t{1} << 24;
+    constexpr size_t CACHE_SLOTS = 8;
+
+    size_t get_page_size()
+    {
+        static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+    constexpr size_t round_up(const size_t size, const size_t alignment)
+    {
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    size_t get_class(const size_t size)
+    {
+        return size <= slab_allocator::MIN_BLOCK ? 0 : std::bit_width(size - 1) - std::bit_width(slab_allocator::MIN_BLOCK - 1);
+    }
+
+    constexpr uint64_t make_handle(const uint64_t klass, const uint64_t slab, const uint64_t block)
+    {
+        return klass << 56 | slab << 32 | block;
+    }
+
+    struct region_mapping
+    {
+        std::byte *base = nullptr;
+        size_t size = 0;
+
+        bool huge = false;
+    };
+
+    /*
+     * Maps `total` bytes and unmaps whatever lies outside the `size` bytes starting at the first `alignment` boundary.
+     */
+    std::byte *trim(void *raw, const size_t total, const size_t size, const size_t alignment)
+    {
+        const auto start = reinterpret_cast<uintptr_t>(raw);
+        const auto aligned = round_up(start, alignment);
+
+        if (aligned > start)
+        {
+            munmap(raw, aligned - start);
+        }
+
+        if (start + total > aligned + size)
+        {
+            munmap(reinterpret_cast<void *>(aligned + size), start + total - (aligned + size));
+        }
+
+        return reinterpret_cast<std::byte *>(aligned);
+    }
+
+    region_mapping map_region(const size_t size, const size_t alignment, const slab_allocator::huge_page_mode mode, std::atomic<size_t> &fallbacks)
+    {
+#ifdef __linux__
+        if (mode == slab_allocator::EXPLICIT_HUGE_PAGES)
+        {
+            const size_t rounded = round_up(size, HUGE_PAGE_SIZE);
+            const size_t extra = alignment > HUGE_PAGE_SIZE ? alignment : 0;
+
+            void *raw = mmap(nullptr, rounded + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+            if (raw != MAP_FAILED)
+            {
+                return {trim(raw, rounded + extra, rounded, std::max(alignment, HUGE_PAGE_SIZE)), rounded, true};
+            }
+
+            fallbacks.fetch_add(1, std::memory_order_relaxed);
+        }
+#endif
+
+        const size_t rounded = round_up(size, get_page_size());
+        const size_t extra = alignment > get_page_size() ? alignment : 0;
+
+        void *raw = mmap(nullptr, rounded + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (raw == MAP_FAILED)
+        {
+            return {};
+        }
+
+        auto *base = trim(raw, rounded + extra, rounded, std::max(alignment, get_page_size()));
+
+#ifdef __linux__
+        if (mode == slab_allocator::TRANSPARENT_HUGE_PAGES)
+        {
+            madvise(base, rounded, MADV_HUGEPAGE);
+        }
+#endif
+
+        return {base, rounded, false};
+    }
+}
+
+namespace znb_kit
+{
+    struct slab_allocator::state
+    {
+        struct slab
+        {
+            region_mapping region;
+
+            size_t klass;
+            size_t block_size;
+            uint32_t blocks;
+
+            std::unique_ptr<std::atomic<uint64_t>[]> live;
+        };
+
+        struct size_class
+        {
+            std::mutex mutex;
+            std::vector<uint64_t> free;
+        };
+
+        struct large_region
+        {
+            region_mapping region;
+            size_t requested;
+        };
+
+        static inline std::atomic<uint64_t> next_id{1};
+
+        const uint64_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+
+        options settings;
+
+        std::unique_ptr<std::atomic<slab *>[]> slabs;
+        std::atomic<size_t> slab_count{0};
+        std::array<size_class, CLASS_COUNT> classes;
+
+        mutable std::shared_mutex index_mutex;
+        std::unordered_map<uintptr_t, uint32_t> slab_index;
+
+        mutable std::mutex large_mutex;
+        std::unordered_map<uint32_t, large_region> large;
+        std::unordered_map<uintptr_t, uint32_t> large_index;
+        uint32_t next_large = 0;
+
+        std::atomic<size_t> fallbacks{0};
+
+        explicit state(const options &options) : settings(options)
+        {
+            settings.slab_size = std::bit_ceil(std::max(settings.slab_size, HUGE_PAGE_SIZE));
+            settings.max_slabs = std::min(settings.max_slabs, MAX_SLABS);
+
+            if (settings.max_slabs == 0)
+            {
+                throw std::invalid_argument("max_slabs has to be positive");
+            }
+
+            slabs = std::make_unique<std::atomic<slab *>[]>(settings.max_slabs);
+        }
+
+        state(const state &) = delete;
+        state &operator=(const state &) = delete;
+
+        ~state()
+        {
+            for (size_t i = 0; i < get_slab_limit(); ++i)
+            {
+                if (const auto *slab = slabs[i].load(std::memory_order_acquire))
+                {
+                    munmap(slab->region.base, slab->region.size);
+                    delete slab;
+                }
+            }
+
+            for (const auto &[id, region] : large)
+            {
+                munmap(region.region.base, region.region.size);
+            }
+        }
+
+        [[nodiscard]] size_t get_slab_limit() const
+        {
+            return std::min(slab_count.load(std::memory_order_acquire), settings.max_slabs);
+        }
+
+        /*
+         * Slab of a size-class handle, or nullptr when the handle cannot belong to this allocator.
+         */
+        [[nodiscard]] slab *get_slab(const uint64_t handle) const
+        {
+            const uint64_t klass = handle >> 56;
+            const uint64_t index = handle >> 32 & 0xFFFFFF;
+
+            if (klass == 0 || klass > CLASS_COUNT || index >= settings.max_slabs)
+            {
+                return nullptr;
+            }
+
+            auto *slab = slabs[index].load(std::memory_order_acquire);
+
+            if (slab == nullptr || slab->klass != klass - 1 || static_cast<uint32_t>(handle) >= slab->blocks)
+            {
+                return nullptr;
+            }
+
+            return slab;
+        }
+
+        /*
+         * Called with the class lock held.
+         */
+        void add_slab(const size_t klass)
+        {
+            const size_t index = slab_count.fetch_add(1, std::memory_order_acq_rel);
+
+            if (index >= settings.max_slabs)
+            {
+                debug_print("slab_allocator::add_slab() reached max_slabs");
+                throw std::bad_alloc();
+            }
+
+            const auto region = map_region(settings.slab_size, settings.slab_size, settings.huge_pages, fallbacks);
+
+            if (region.base == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            auto *slab = new state::slab{region, klass, MIN_BLOCK << klass, static_cast<uint32_t>(region.size / (MIN_BLOCK << klass)), nullptr};
+            slab->live = std::make_unique<std::atomic<uint64_t>[]>((slab->blocks + 63) / 64);
+
+            {
+                std::unique_lock lock(index_mutex);
+                slab_index.emplace(reinterpret_cast<uintptr_t>(region.base), static_cast<uint32_t>(index));
+            }
+
+            slabs[index].store(slab, std::memory_order_release);
+
+            auto &free = classes[klass].free;
+
+            /*
+             * Reversed, so blocks go out in address order.
+             */
+            for (uint32_t block = slab->blocks; block-- > 0;)
+            {
+                free.push_back(make_handle(klass + 1, index, block));
+            }
+        }
+
+        void refill(const size_t klass, std::vector<uint64_t> &out, const size_t count)
+        {
+            auto &size_class = classes[klass];
+            std::lock_guard lock(size_class.mutex);
+
+            if (size_class.free.size() < count)
+            {
+                add_slab(klass);
+            }
+
+            const size_t taken = std::min(count, size_class.free.size());
+
+            out.insert(out.end(), size_class.free.end() - static_cast<ptrdiff_t>(taken), size_class.free.end());
+            size_class.free.resize(size_class.free.size() - taken);
+        }
+
+        /*
+         * Hands back all but the `keep` most recently freed blocks.
+         */
+        void flush(const size_t klass, std::vector<uint64_t> &from, const size_t keep)
+        {
+            if (from.size() <= keep)
+            {
+                return;
+            }
+
+            const auto end = from.end() - static_cast<ptrdiff_t>(keep);
+
+            {
+                auto &size_class = classes[klass];
+                std::lock_guard lock(size_class.mutex);
+
+                size_class.free.insert(size_class.free.end(), from.begin(), end);
+            }
+
+            from.erase(from.begin(), end);
+        }
+
+        slice allocate_large(const size_t size)
+        {
+            const auto region = map_region(size, get_page_size(), settings.huge_pages, fallbacks);
+
+            if (region.base == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            std::lock_guard lock(large_mutex);
+
+            while (large.contains(next_large))
+            {
+                next_large = (next_large + 1) % MAX_SLABS;
+            }
+
+            const uint32_t index = next_large;
+            next_large = (next_large + 1) % MAX_SLABS;
+
+            large.emplace(index, large_region{region, size});
+            large_index.emplace(reinterpret_cast<uintptr_t>(region.base), index);
+
+            return {make_handle(LARGE_CLASS, index, 0), {region.base, size}};
+        }
+
+        bool free_large(const uint64_t handle)
+        {
+            region_mapping region;
+
+            {
+                std::lock_guard lock(large_mutex);
+
+                const auto it = large.find(static_cast<uint32_t>(handle >> 32 & 0xFFFFFF));
+
+                if (it == large.end() || static_cast<uint32_t>(handle) != 0)
+                {
+                    return false;
+                }
+
+                region = it->second.region;
+
+                large_index.erase(reinterpret_cast<uintptr_t>(region.base));
+                large.erase(it);
+            }
+
+            munmap(region.base, region.size);
+
+            return true;
+        }
+
+        /*
+         * Clears the live bit of a size-class block; false for foreign handles and double frees.
+         */
+        bool retire(const uint64_t handle) const
+        {
+            auto *slab = get_slab(handle);
+
+            if (slab == nullptr)
+            {
+                return false;
+            }
+
+            const auto block = static_cast<uint32_t>(handle);
+            const uint64_t bit = uint64_t{1} << (block % 64);
+
+            return (slab->live[block / 64].fetch_and(~bit, std::memory_order_acq_rel) & bit) != 0;
+        }
+    };
+}
+
+namespace
+{
+    /*
+     * Per-thread free blocks of one allocator, in a small direct-mapped table keyed by allocator id. A thread that
+     * switches allocators on a slot, or exits, hands its blocks back to the previous owner if that one still exists.
+     */
+    struct cache_entry
+    {
+        uint64_t owner = 0;
+        std::weak_ptr<slab_allocator::state> target;
+
+        std::array<std::vector<uint64_t>, slab_allocator::CLASS_COUNT> blocks;
+
+        void flush()
+        {
+            if (const auto state = target.lock())
+            {
+                for (size_t klass = 0; klass < blocks.size(); ++klass)
+                {
+                    state->flush(klass, blocks[klass], 0);
+                }
+            }
+
+            for (auto &list : blocks)
+            {
+                list.clear();
+            }
+
+            owner = 0;
+            target.reset();
+        }
+
+        ~cache_entry()
+        {
+            flush();
+        }
+    };
+
+    thread_local std::array<cache_entry, CACHE_SLOTS> caches;
+
+    cache_entry &get_cache(const std::shared_ptr<slab_allocator::state> &state)
+    {
+        auto &entry = caches[state->id % CACHE_SLOTS];
+
+        if (entry.owner != state->id)
+        {
+            entry.flush();
+
+            entry.owner = state->id;
+            entry.target = state;
+        }
+
+        return entry;
+    }
+}
+
+namespace znb_kit
+{
+    slab_allocator::slab_allocator(const options &options) : shared(std::make_shared<state>(options))
+    {
+    }
+
+    slab_allocator::~slab_allocator() = default;
+
+    slab_allocator::slice slab_allocator::allocate(const size_t size)
+    {
+        if (size > MAX_BLOCK)
+        {
+            return shared->allocate_large(size);
+        }
+
+        const size_t klass = get_class(size);
+        auto &blocks = get_cache(shared).blocks[klass];
+
+        if (blocks.empty())
+        {
+            shared->refill(klass, blocks, std::max<size_t>(1, shared->settings.thread_cache / 2));
+        }
+
+        const uint64_t handle = blocks.back();
+        blocks.pop_back();
+
+        auto *slab = shared->get_slab(handle);
+        const auto block = static_cast<uint32_t>(handle);
+
+        slab->live[block / 64].fetch_or(uint64_t{1} << (block % 64), std::memory_order_acq_rel);
+
+        return {handle, {slab->region.base + block * slab->block_size, size}};
+    }
+
+    void slab_allocator::free(const uint64_t handle)
+    {
+        if (free_bulk(std::span(&handle, 1)) == 0)
+        {
+            throw std::invalid_argument(std::format("Handle {:#x} is not live in this allocator", handle));
+        }
+    }
+
+    size_t slab_allocator::free_bulk(const std::span<const uint64_t> handles)
+    {
+        auto &cache = get_cache(shared);
+        size_t freed = 0;
+
+        for (const uint64_t handle : handles)
+        {
+            if (handle >> 56 == LARGE_CLASS)
+            {
+                freed += shared->free_large(handle);
+                continue;
+            }
+
+            if (!shared->retire(handle))
+            {
+                debug_print(std::format("slab_allocator::free_bulk() skipped handle {:#x}", handle));
+                continue;
+            }
+
+            const size_t klass = (handle >> 56) - 1;
+            auto &blocks = cache.blocks[klass];
+
+            blocks.push_back(handle);
+
+            if (blocks.size() > shared->settings.thread_cache)
+            {
+                shared->flush(klass, blocks, shared->settings.thread_cache / 2);
+            }
+
+            ++freed;
+        }
+
+        return freed;
+    }
+
+    std::span<std::byte> slab_allocator::get(const uint64_t handle) const
+    {
+        if (handle >> 56 == LARGE_CLASS)
+        {
+            std::lock_guard lock(shared->large_mutex);
+
+            const auto it = shared->large.find(static_cast<uint32_t>(handle >> 32 & 0xFFFFFF));
+
+            if (it != shared->large.end() && static_cast<uint32_t>(handle) == 0)
+            {
+                return {it->second.region.base, it->second.requested};
+            }
+        }
+        else if (const auto *slab = shared->get_slab(handle))
+        {
+            const auto block = static_cast<uint32_t>(handle);
+
+            if ((slab->live[block / 64].load(std::memory_order_acquire) >> (block % 64) & 1) != 0)
+            {
+                return {slab->region.base + block * slab->block_size, slab->block_size};
+            }
+        }
+
+        throw std::invalid_argument(std::format("Handle {:#x} is not live in this allocator", handle));
+    }
+
+    jobject slab_allocator::allocate_java(JNIEnv *env, const size_t size)
+    {
+        VAR_CHECK(env);
+
+        const auto slice = allocate(size);
+        const auto view = env->NewDirectByteBuffer(slice.memory.data(), static_cast<jlong>(size));
+
+        if (view == nullptr || env->ExceptionCheck())
+        {
+            free(slice.handle);
+
+            EXCEPT_CHECK(env);
+            throw std::runtime_error("NewDirectByteBuffer failed, direct buffer access is not supported by this VM");
+        }
+
+        return view;
+    }
+
+    uint64_t slab_allocator::handle_of(JNIEnv *env, const jobject &byte_buffer) const
+    {
+        const auto address = reinterpret_cast<uintptr_t>(buffer::get_direct(env, byte_buffer).data());
+
+        {
+            std::lock_guard lock(shared->large_mutex);
+
+            if (const auto it = shared->large_index.find(address); it != shared->large_index.end())
+            {
+                return make_handle(LARGE_CLASS, it->second, 0);
+            }
+        }
+
+        const uintptr_t base = address & ~(shared->settings.slab_size - 1);
+        std::optional<uint32_t> index;
+
+        {
+            std::shared_lock lock(shared->index_mutex);
+
+            if (const auto it = shared->slab_index.find(base); it != shared->slab_index.end())
+            {
+                index = it->second;
+            }
+        }
+
+        if (index)
+        {
+            const auto *slab = shared->slabs[*index].load(std::memory_order_acquire);
+
+            if (slab != nullptr && (address - base) % slab->block_size == 0)
+            {
+                return make_handle(slab->klass + 1, *index, (address - base) / slab->block_size);
+            }
+        }
+
+        throw std::invalid_argument("Buffer was not allocated by this allocator");
+    }
+
+    size_t slab_allocator::free_bulk(JNIEnv *env, const jlongArray &handles)
+    {
+        VAR_CHECK(env);
+        VAR_CHECK(handles);
+
+        std::vector<uint64_t> values(static_cast<size_t>(env->GetArrayLength(handles)));
+        env->GetLongArrayRegion(handles, 0, static_cast<jsize>(values.size()), reinterpret_cast<jlong *>(values.data()));
+
+        EXCEPT_CHECK(env);
+
+        return free_bulk(values);
+    }
+
+    slab_allocator::stats slab_allocator::get_stats() const
+    {
+        stats result;
+        result.classes.resize(CLASS_COUNT);
+
+        for (size_t klass = 0; klass < CLASS_COUNT; ++klass)
+        {
+            result.classes[klass].block_size = MIN_BLOCK << klass;
+        }
+
+        for (size_t i = 0; i < shared->get_slab_limit(); ++i)
+        {
+            const auto *slab = shared->slabs[i].load(std::memory_order_acquire);
+
+            if (slab == nullptr)
+            {
+                continue;
+            }
+
+            auto &klass = result.classes[slab->klass];
+
+            ++klass.slabs;
+            klass.blocks += slab->blocks;
+
+            for (size_t word = 0; word < (slab->blocks + 63) / 64; ++word)
+            {
+                klass.in_use += std::popcount(slab->live[word].load(std::memory_order_relaxed));
+            }
+
+            ++result.slabs;
+            result.huge_page_slabs += slab->region.huge;
+            result.reserved_bytes += slab->region.size;
+        }
+
+        for (const auto &klass : result.classes)
+        {
+            result.in_use_bytes += klass.in_use * klass.block_size;
+        }
+
+        {
+            std::lock_guard lock(shared->large_mutex);
+
+            for (const auto &[id, region] : shared->large)
+            {
+                ++result.large_allocations;
+
+                result.large_bytes += region.region.size;
+                result.reserved_bytes += region.region.size;
+                result.in_use_bytes += region.requested;
+            }
+        }
+
+        result.huge_page_fallbacks = shared->fallbacks.load(std::memory_order_relaxed);
+
+        return result;
+    }
+
+    std::string slab_allocator::stats::to_json() const
+    {
+        std::string json = std::format("{{\"reserved_bytes\":{},\"in_use_bytes\":{},\"slabs\":{},\"huge_page_slabs\":{},"
+                                       "\"huge_page_fallbacks\":{},\"large_allocations\":{},\"large_bytes\":{},\"classes\":[",
+            reserved_bytes, in_use_bytes, slabs, huge_page_slabs, huge_page_fallbacks, large_allocations, large_bytes);
+
+        for (size_t i = 0; i < classes.size(); ++i)
+        {
+            json += std::format("{}{{\"block_size\":{},\"slabs\":{},\"blocks\":{},\"in_use\":{}}}",
+                i == 0 ? "" : ",", classes[i].block_size, classes[i].slabs, classes[i].blocks, classes[i].in_use);
+        }
+
+        return json + "]}";
+    }
+}
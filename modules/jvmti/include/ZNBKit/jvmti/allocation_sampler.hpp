@@ -0,0 +1,109 @@
+#pragma once
+
+#include <jvmti.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ZNBKit/internal/spsc_ring.hpp"
+#include "ZNBKit/jvmti/jvmti_callbacks.hpp"
+#include "ZNBKit/jvmti/jvmti_symbolizer.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Heap allocation profiler on top of SampledObjectAlloc. The callback copies the class signature and a truncated
+     * stack into a fixed-size record and pushes it into the allocating thread's ring; aggregation by site happens
+     * only when top_sites() drains the rings. Requires can_generate_sampled_object_alloc_events.
+     */
+    class allocation_sampler final : public jvmti_listener
+    {
+    public:
+        static constexpr size_t max_frames = 16;
+        static constexpr size_t max_klass_length = 96;
+
+        struct options
+        {
+            jint interval = 512 * 1024;
+            jint max_depth = 8;
+        };
+
+        struct site
+        {
+            std::string klass;
+            std::vector<std::string> stack;
+
+            size_t samples = 0;
+            jlong bytes = 0;
+        };
+
+    private:
+        struct sample
+        {
+            char klass[max_klass_length];
+            jlong size;
+
+            jint depth;
+            jmethodID frames[max_frames];
+        };
+
+        struct aggregate
+        {
+            std::string klass;
+            std::vector<jmethodID> frames;
+
+            size_t samples = 0;
+            jlong bytes = 0;
+        };
+
+        jvmtiEnv *jvmti;
+        jvmti_symbolizer symbolizer;
+
+        jint max_depth = 8;
+        bool running = false;
+
+        /*
+         * Preallocated, so the SampledObjectAlloc callback never allocates on its own behalf.
+         */
+        thread_rings<sample, 256> rings{64};
+
+        std::mutex aggregates_mutex;
+        std::unordered_map<std::string, aggregate> aggregates;
+
+        void collect();
+
+    public:
+        explicit allocation_sampler(jvmtiEnv *jvmti);
+
+        allocation_sampler(const allocation_sampler &) = delete;
+        allocation_sampler &operator=(const allocation_sampler &) = delete;
+
+        ~allocation_sampler() override;
+
+        void start(const options &options);
+
+        void start()
+        {
+            start(options{});
+        }
+
+        void stop();
+
+        void reset();
+
+        /*
+         * Sites ordered by sampled bytes. Pass the caller's JNIEnv when calling from an attached native thread.
+         */
+        std::vector<site> top_sites(size_t count, JNIEnv *jni = nullptr);
+
+        [[nodiscard]] size_t get_dropped() const
+        {
+            return rings.get_dropped();
+        }
+
+        void on_sampled_object_alloc(jvmtiEnv *, JNIEnv *, jthread, jobject, jclass klass, jlong size) override;
+
+        void on_thread_end(jvmtiEnv *, JNIEnv *, jthread) override;
+    };
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <jvmti.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ZNBKit/jvmti/jvmti_callbacks.hpp"
+
+namespace znb_kit
+{
+    /*
+     * A single bytecode rewriting step. Returning nullopt leaves the class as it is. The version takes part in the
+     * cache key, so bump it whenever the produced bytes would change for the same input.
+     */
+    class class_transformer
+    {
+    public:
+        virtual ~class_transformer() = default;
+
+        [[nodiscard]] virtual std::string get_name() const = 0;
+
+        [[nodiscard]] virtual uint32_t get_version() const
+        {
+            return 1;
+        }
+
+        /*
+         * Internal class name, e.g. "java/lang/String".
+         */
+        [[nodiscard]] virtual bool accepts(std::string_view) const
+        {
+            return true;
+        }
+
+        virtual std::optional<std::vector<unsigned char>> transform(std::string_view class_name, std::span<const unsigned char> bytes) = 0;
+    };
+
+    /*
+     * Runs registered transformers from ClassFileLoadHook, in registration order, and hands the result back to the VM
+     * in JVMTI-allocated memory. Results are cached by class name and a hash of the input bytes and the transformer
+     * chain, optionally on disk, so an unchanged class on a later start is answered from the cache without running any
+     * transformer. Cached entries carry the class name and input size, which are checked before an entry is used.
+     */
+    class class_transform_pipeline final : public jvmti_listener
+    {
+    public:
+        struct options
+        {
+            /*
+             * Persistent cache location, created when missing. Without it the cache only lives in memory.
+             */
+            std::optional<std::filesystem::path> cache_directory;
+        };
+
+        struct transformer_stats
+        {
+            std::string name;
+
+            size_t invocations = 0;
+            size_t transformed = 0;
+
+            std::chrono::nanoseconds time{0};
+        };
+
+        struct stats
+        {
+            std::vector<transformer_stats> transformers;
+
+            size_t cache_hits = 0;
+            size_t cache_misses = 0;
+            size_t failures = 0;
+        };
+
+    private:
+        struct entry
+        {
+            std::shared_ptr<class_transformer> transformer;
+
+            std::atomic_size_t invocations{0};
+            std::atomic_size_t transformed{0};
+            std::atomic<int64_t> time{0};
+        };
+
+        /*
+         * nullopt marks a class that no transformer changed, which is worth caching just as much.
+         */
+        using cached_result = std::optional<std::vector<unsigned char>>;
+
+        struct cache_key
+        {
+            std::string name;
+            uint64_t hash;
+            size_t size;
+
+            [[nodiscard]] std::string to_string() const;
+        };
+
+        struct cached_entry
+        {
+            size_t size;
+            cached_result result;
+        };
+
+        jvmtiEnv *jvmti;
+        bool running = false;
+
+        std::vector<std::unique_ptr<entry>> entries;
+        uint64_t chain_key = 0;
+
+        std::optional<std::filesystem::path> cache_directory;
+
+        /*
+         * Untouched classes are not written out one file each but appended to a single index, loaded on start.
+         */
+        std::mutex cache_mutex;
+        std::unordered_map<std::string, cached_entry> cache;
+
+        std::atomic_size_t cache_hits{0};
+        std::atomic_size_t cache_misses{0};
+        std::atomic_size_t failures{0};
+
+        void load_untouched_index();
+
+        std::optional<cached_result> load_cached(const cache_key &key);
+
+        void store_cached(const cache_key &key, const cached_result &result);
+
+        cached_result run_chain(std::string_view class_name, std::span<const unsigned char> bytes);
+
+    public:
+        explicit class_transform_pipeline(jvmtiEnv *jvmti);
+
+        class_transform_pipeline(const class_transform_pipeline &) = delete;
+        class_transform_pipeline &operator=(const class_transform_pipeline &) = delete;
+
+        ~class_transform_pipeline() override;
+
+        /*
+         * Transformers can only be added while the pipeline is stopped.
+         */
+        void add(std::shared_ptr<class_transformer> transformer);
+
+        void start(const options &options);
+
+        void start()
+        {
+            start(options{});
+        }
+
+        void stop();
+
+        [[nodiscard]] stats get_stats() const;
+
+        void on_class_file_load(jvmtiEnv *, JNIEnv *, jclass, jobject, const char *name, jobject,
+                                jint class_data_len, const unsigned char *class_data, jint *new_class_data_len,
+                                unsigned char **new_class_data) override;
+    };
+}
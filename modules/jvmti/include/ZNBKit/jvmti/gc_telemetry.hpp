@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <jvmti.h>
+#include <optional>
+
+#include "ZNBKit/internal/histogram.hpp"
+#include "ZNBKit/jvmti/jvmti_callbacks.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Stop-the-world pause statistics from GarbageCollectionStart/Finish. Both callbacks run inside the pause, so they
+     * only touch atomics; durations go into a nanosecond log-linear histogram. in_gc() and since_last_gc() are meant
+     * for native code deciding whether now is a good moment for a long critical section.
+     * Requires can_generate_garbage_collection_events.
+     */
+    class gc_telemetry final : public jvmti_listener
+    {
+    public:
+        struct pause_snapshot
+        {
+            uint64_t pauses = 0;
+
+            std::chrono::nanoseconds total{0};
+            std::chrono::nanoseconds mean{0};
+            std::chrono::nanoseconds max{0};
+
+            std::chrono::nanoseconds p50{0};
+            std::chrono::nanoseconds p90{0};
+            std::chrono::nanoseconds p99{0};
+            std::chrono::nanoseconds p999{0};
+
+            log_histogram<>::snapshot histogram;
+        };
+
+    private:
+        jvmtiEnv *jvmti;
+        bool running = false;
+
+        log_histogram<> pauses;
+
+        std::atomic<int64_t> started_at{0};
+        std::atomic<int64_t> finished_at{0};
+        std::atomic<uint64_t> collections{0};
+
+        static int64_t now();
+
+    public:
+        explicit gc_telemetry(jvmtiEnv *jvmti);
+
+        gc_telemetry(const gc_telemetry &) = delete;
+        gc_telemetry &operator=(const gc_telemetry &) = delete;
+
+        ~gc_telemetry() override;
+
+        void start();
+
+        void stop();
+
+        /*
+         * Pause statistics since the previous resetting snapshot (or since start()).
+         */
+        pause_snapshot snapshot(bool reset = true);
+
+        [[nodiscard]] bool in_gc() const;
+
+        /*
+         * Time since the end of the last pause, empty until the first collection finished.
+         */
+        [[nodiscard]] std::optional<std::chrono::nanoseconds> since_last_gc() const;
+
+        [[nodiscard]] uint64_t get_collections() const
+        {
+            return collections.load(std::memory_order_relaxed);
+        }
+
+        void on_garbage_collection_start(jvmtiEnv *) override;
+
+        void on_garbage_collection_finish(jvmtiEnv *) override;
+    };
+}
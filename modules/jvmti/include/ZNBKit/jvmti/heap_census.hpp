@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <jvmti.h>
+#include <string>
+#include <vector>
+
+#include "ZNBKit/jvmti/jvmti_symbolizer.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Per-class instance counts and shallow sizes through IterateThroughHeap. Loaded classes are tagged with their index
+     * in a short-lived JVMTI environment of the census' own, so each visited object reports its class through class_tag
+     * without touching tags set through the caller's environment. The VM has to allow can_tag_objects.
+     */
+    class heap_census
+    {
+    public:
+        struct class_usage
+        {
+            std::string klass;
+
+            jlong instances = 0;
+            jlong bytes = 0;
+        };
+
+        struct snapshot
+        {
+            std::vector<class_usage> classes;
+
+            jlong instances = 0;
+            jlong bytes = 0;
+
+            std::chrono::steady_clock::time_point taken_at;
+
+            [[nodiscard]] std::string to_json() const;
+        };
+
+        struct difference
+        {
+            std::string klass;
+
+            jlong instances = 0;
+            jlong bytes = 0;
+        };
+
+    private:
+        jvmtiEnv *jvmti;
+        jvmti_symbolizer symbolizer;
+
+    public:
+        explicit heap_census(jvmtiEnv *jvmti);
+
+        /*
+         * Classes are ordered by shallow size, largest first. Forcing a collection first limits the census to live objects.
+         */
+        snapshot take(JNIEnv *jni, bool collect_garbage = false);
+
+        /*
+         * Per-class growth from `before` to `after`, ordered by the absolute byte delta. Unchanged classes are omitted.
+         */
+        static std::vector<difference> diff(const snapshot &before, const snapshot &after);
+
+        static std::string to_json(const std::vector<difference> &differences);
+    };
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <jvmti.h>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ZNBKit/jni/signatures/method_signature.hpp"
+#include "ZNBKit/jvmti/jvmti_callbacks.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Drives a set of methods until the JIT has installed code at the highest tier they will reach. JVMTI does not report
+     * the compilation tier, so a target counts as done once its code was already installed before the run (replayed through
+     * GenerateEvents), on its first CompiledMethodLoad when only one tier is available (-XX:-TieredCompilation or a
+     * TieredStopAtLevel below 4), on its second one under tiered compilation (the C2 replacement of the C1 version), or
+     * when no replacement followed the first one within `settle`, as trivial methods never leave tier 1.
+     * Requires can_generate_compiled_method_load_events.
+     */
+    class jit_warmup final : public jvmti_listener
+    {
+    public:
+        struct target
+        {
+            jclass owner = nullptr;
+            jobject instance = nullptr;
+            jmethodID method = nullptr;
+
+            std::string signature;
+            bool is_static = false;
+
+            /*
+             * When empty, arguments are synthesized from the signature: zero for primitives, "" for strings and null otherwise.
+             */
+            std::optional<std::vector<jvalue>> arguments;
+
+            template <typename T>
+            static target from(const method_signature<T> &method, const jobject instance = nullptr)
+            {
+                if (!method.is_static_method() && instance == nullptr)
+                {
+                    throw std::invalid_argument("Instance method '" + method.name + "' needs an instance to warm up.");
+                }
+
+                target result;
+                result.owner = method.get_owner();
+                result.instance = instance;
+                result.method = method.get_identity();
+                result.signature = method.signature;
+                result.is_static = method.is_static_method();
+
+                return result;
+            }
+        };
+
+        struct options
+        {
+            size_t batch = 1000;
+
+            std::chrono::milliseconds settle{250};
+
+            std::chrono::milliseconds budget{10000};
+        };
+
+        struct target_report
+        {
+            std::string name;
+
+            size_t invocations = 0;
+            size_t compilations = 0;
+            size_t exceptions = 0;
+
+            bool reached = false;
+            bool precompiled = false;
+            std::chrono::nanoseconds time_to_reach{};
+        };
+
+    private:
+        struct progress
+        {
+            std::atomic_size_t compilations{0};
+            std::atomic_bool replayed{false};
+
+            /*
+             * steady_clock nanoseconds of the first load outside the replay.
+             */
+            std::atomic<int64_t> first_compiled_at{0};
+        };
+
+        jvmtiEnv *jvmti;
+
+        std::unordered_map<jmethodID, size_t> indices;
+        std::unique_ptr<progress[]> states;
+
+        /*
+         * GenerateEvents delivers the replay on the calling thread, which tells it apart from fresh compilations.
+         */
+        std::atomic<std::thread::id> replaying_thread{};
+
+        static bool is_single_tier(JNIEnv *jni);
+
+        static std::vector<jvalue> synthesize_arguments(JNIEnv *jni, const std::string &signature, std::vector<jobject> &locals);
+
+        static bool invoke(JNIEnv *jni, const target &target, const std::vector<jvalue> &arguments);
+
+    public:
+        explicit jit_warmup(jvmtiEnv *jvmti);
+
+        jit_warmup(const jit_warmup &) = delete;
+        jit_warmup &operator=(const jit_warmup &) = delete;
+
+        std::vector<target_report> run(JNIEnv *jni, const std::vector<target> &targets, const options &options);
+
+        void on_compiled_method_load(jvmtiEnv *, jmethodID method, jint, const void *, jint, const jvmtiAddrLocationMap *, const void *) override;
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <jvmti.h>
+#include <mutex>
+#include <vector>
+
+namespace znb_kit
+{
+    /*
+     * Receiver for JVMTI events. Methods are invoked directly on the thread that raised the event, so implementations
+     * have to respect the JVMTI restrictions of each event (no JNI in GC and ObjectFree callbacks, for example).
+     */
+    class jvmti_listener
+    {
+    public:
+        virtual ~jvmti_listener() = default;
+
+        virtual void on_vm_death(jvmtiEnv *, JNIEnv *) {}
+
+        virtual void on_thread_start(jvmtiEnv *, JNIEnv *, jthread) {}
+
+        virtual void on_thread_end(jvmtiEnv *, JNIEnv *, jthread) {}
+
+        virtual void on_class_file_load(jvmtiEnv *, JNIEnv *, jclass, jobject, const char *, jobject,
+                                        jint, const unsigned char *, jint *, unsigned char **) {}
+
+        virtual void on_class_load(jvmtiEnv *, JNIEnv *, jthread, jclass) {}
+
+        virtual void on_class_prepare(jvmtiEnv *, JNIEnv *, jthread, jclass) {}
+
+        virtual void on_compiled_method_load(jvmtiEnv *, jmethodID, jint, const void *, jint, const jvmtiAddrLocationMap *, const void *) {}
+
+        virtual void on_compiled_method_unload(jvmtiEnv *, jmethodID, const void *) {}
+
+        virtual void on_dynamic_code_generated(jvmtiEnv *, const char *, const void *, jint) {}
+
+        virtual void on_garbage_collection_start(jvmtiEnv *) {}
+
+        virtual void on_garbage_collection_finish(jvmtiEnv *) {}
+
+        virtual void on_object_free(jvmtiEnv *, jlong) {}
+
+        virtual void on_sampled_object_alloc(jvmtiEnv *, JNIEnv *, jthread, jobject, jclass, jlong) {}
+    };
+
+    /*
+     * A JVMTI environment has a single callback table, so every component that needs events subscribes here instead of
+     * calling SetEventCallbacks itself. Dispatch does not lock or allocate: listeners sit in a fixed array of slots and
+     * an in-flight counter per slot lets unsubscribe() wait for running callbacks before returning.
+     */
+    class jvmti_callbacks
+    {
+        static constexpr size_t max_listeners = 16;
+        static constexpr size_t event_count = JVMTI_MAX_EVENT_TYPE_VAL - JVMTI_MIN_EVENT_TYPE_VAL + 1;
+
+        struct slot
+        {
+            std::atomic<jvmti_listener *> listener{nullptr};
+            std::atomic<uint64_t> events{0};
+            std::atomic<uint32_t> active{0};
+        };
+
+        static std::array<slot, max_listeners> slots;
+        static std::array<size_t, event_count> event_references;
+
+        static std::mutex mutex;
+        static jvmtiEnv *installed;
+
+        static void install(jvmtiEnv *jvmti);
+
+        static void set_event(jvmtiEnv *jvmti, jvmtiEvent event, bool enable);
+
+        template <typename Fn>
+        static void dispatch(jvmtiEvent event, Fn &&fn)
+        {
+            const uint64_t bit = uint64_t{1} << (event - JVMTI_MIN_EVENT_TYPE_VAL);
+
+            for (auto &slot : slots)
+            {
+                jvmti_listener *listener = slot.listener.load(std::memory_order_acquire);
+
+                if (listener == nullptr || (slot.events.load(std::memory_order_relaxed) & bit) == 0)
+                {
+                    continue;
+                }
+
+                /*
+                 * Store (active) then load (listener) here, store (listener) then load (active) in unsubscribe: only
+                 * sequential consistency rules out both sides missing each other's store.
+                 */
+                slot.active.fetch_add(1, std::memory_order_seq_cst);
+
+                if (slot.listener.load(std::memory_order_seq_cst) == listener)
+                {
+                    fn(listener);
+                }
+
+                slot.active.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        friend struct jvmti_trampolines;
+
+    public:
+        static void subscribe(jvmtiEnv *jvmti, jvmti_listener *listener, const std::vector<jvmtiEvent> &events);
+
+        static void unsubscribe(jvmtiEnv *jvmti, const jvmti_listener *listener);
+    };
+}
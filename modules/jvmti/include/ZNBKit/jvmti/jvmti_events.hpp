@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <jvmti.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ZNBKit/internal/spsc_ring.hpp"
+#include "ZNBKit/jvmti/jvmti_callbacks.hpp"
+
+namespace znb_kit
+{
+    struct jvmti_event
+    {
+        static constexpr size_t max_name_length = 96;
+
+        enum event_type : uint8_t
+        {
+            CLASS_LOAD,
+            CLASS_PREPARE,
+            THREAD_START,
+            THREAD_END,
+            GARBAGE_COLLECTION_START,
+            GARBAGE_COLLECTION_FINISH,
+            COMPILED_METHOD_LOAD,
+            COMPILED_METHOD_UNLOAD,
+            DYNAMIC_CODE_GENERATED,
+        };
+
+        event_type type;
+
+        /*
+         * steady_clock nanoseconds and a process-local id of the thread that raised the event.
+         */
+        int64_t timestamp;
+        uint64_t thread;
+
+        jmethodID method;
+        const void *address;
+        jint size;
+
+        /*
+         * Class signature for class events (only with resolve_class_names) or the stub name for DynamicCodeGenerated,
+         * truncated to fit.
+         */
+        char name[max_name_length];
+
+        static constexpr uint32_t mask(const event_type type)
+        {
+            return uint32_t{1} << type;
+        }
+    };
+
+    /*
+     * Off-thread JVMTI event delivery. The callbacks only fill a fixed-size jvmti_event and push it into the raising
+     * thread's lock-free ring; a native dispatcher thread drains the rings and fans the records out to subscribers, so
+     * subscribers may lock, allocate and block without stalling JVM threads. Events that don't fit in a full ring are
+     * counted as dropped rather than waited for.
+     */
+    class jvmti_events final : public jvmti_listener
+    {
+    public:
+        static constexpr uint32_t all_events = ~uint32_t{0};
+
+        using subscriber = std::function<void(const jvmti_event &)>;
+
+        struct options
+        {
+            uint32_t events = all_events;
+
+            /*
+             * GetClassSignature allocates through JVMTI, so class names are left empty unless asked for.
+             */
+            bool resolve_class_names = false;
+        };
+
+    private:
+        struct subscription
+        {
+            size_t id;
+            uint32_t events;
+            subscriber callback;
+        };
+
+        jvmtiEnv *jvmti;
+
+        uint32_t enabled_events = all_events;
+        bool resolve_class_names = false;
+
+        /*
+         * Preallocated, so publishing from a JVMTI callback never allocates.
+         */
+        thread_rings<jvmti_event, 512> rings{64};
+
+        std::thread dispatcher;
+        std::atomic_bool running{false};
+        std::atomic_bool pending{false};
+
+        /*
+         * Copy-on-write: the dispatcher delivers from a snapshot, so subscribers run without holding the mutex.
+         */
+        std::mutex subscriptions_mutex;
+        std::atomic<std::shared_ptr<const std::vector<subscription>>> subscriptions{std::make_shared<const std::vector<subscription>>()};
+        size_t next_subscription = 1;
+
+        std::atomic_size_t delivered{0};
+
+        void publish(jvmti_event &event);
+
+        void publish_class(jvmti_event::event_type type, jclass klass);
+
+        void dispatch();
+
+    public:
+        explicit jvmti_events(jvmtiEnv *jvmti);
+
+        jvmti_events(const jvmti_events &) = delete;
+        jvmti_events &operator=(const jvmti_events &) = delete;
+
+        ~jvmti_events() override;
+
+        void start(const options &options);
+
+        void start()
+        {
+            start(options{});
+        }
+
+        /*
+         * Unsubscribes from JVMTI, delivers whatever is still queued and joins the dispatcher.
+         */
+        void stop();
+
+        /*
+         * Subscribers run on the dispatcher thread, which is not attached to the VM.
+         */
+        size_t subscribe(subscriber callback, uint32_t events = all_events);
+
+        /*
+         * A batch that is already being delivered may still reach the subscriber after this returns.
+         */
+        void unsubscribe(size_t id);
+
+        [[nodiscard]] size_t get_delivered() const
+        {
+            return delivered.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t get_dropped() const
+        {
+            return rings.get_dropped();
+        }
+
+        void on_thread_start(jvmtiEnv *, JNIEnv *, jthread) override;
+
+        void on_thread_end(jvmtiEnv *, JNIEnv *, jthread) override;
+
+        void on_class_load(jvmtiEnv *, JNIEnv *, jthread, jclass klass) override;
+
+        void on_class_prepare(jvmtiEnv *, JNIEnv *, jthread, jclass klass) override;
+
+        void on_compiled_method_load(jvmtiEnv *, jmethodID method, jint code_size, const void *code_addr, jint,
+                                     const jvmtiAddrLocationMap *, const void *) override;
+
+        void on_compiled_method_unload(jvmtiEnv *, jmethodID method, const void *code_addr) override;
+
+        void on_dynamic_code_generated(jvmtiEnv *, const char *name, const void *address, jint length) override;
+
+        void on_garbage_collection_start(jvmtiEnv *) override;
+
+        void on_garbage_collection_finish(jvmtiEnv *) override;
+    };
+}
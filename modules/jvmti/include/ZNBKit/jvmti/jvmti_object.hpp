@@ -11,6 +11,7 @@
 #include <utility>
 #include <vector>
 
+#include "ZNBKit/internal/timeline.hpp"
 #include "ZNBKit/jvmti/jvmti_factory.hpp"
 
 namespace znb_kit
@@ -78,6 +79,8 @@ namespace znb_kit
             const klass_signature &klass_signature,
             const std::unordered_multimap<std::string, jni_bridge_reference> &map)
         {
+            timeline::scope phase("try_mapping_methods", klass_signature.get_name());
+
             std::vector<jni_native_method> mapped_methods;
             size_t total = 0;
 
@@ -88,6 +91,7 @@ namespace znb_kit
               total += pair_result.second;
           }(type_tag<Ts>{})), ...);
 
+            phase.set_count(total);
 
             return {mapped_methods, total};
         }
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <jvmti.h>
+#include <memory>
+#include <string>
+
+namespace znb_kit
+{
+    template<typename JVMTI_ALLOC_TYPE>
+    struct jvmti_deleter
+    {
+        jvmtiEnv *jvmti_env;
+
+        void operator()(JVMTI_ALLOC_TYPE *ptr) const
+        {
+            if (jvmti_env && ptr)
+            {
+                jvmti_env->Deallocate(reinterpret_cast<unsigned char *>(ptr));
+            }
+        }
+    };
+
+    template<typename JVMTI_ALLOC_TYPE>
+    using jvmti_ptr = std::unique_ptr<JVMTI_ALLOC_TYPE, jvmti_deleter<JVMTI_ALLOC_TYPE>>;
+
+    inline std::string get_error_name(jvmtiEnv *jvmti, const jvmtiError error)
+    {
+        char *raw_error_buffer = nullptr;
+        jvmti->GetErrorName(error, &raw_error_buffer);
+
+        const jvmti_ptr<char> error_buffer(raw_error_buffer, {jvmti});
+
+        return error_buffer ? std::string(error_buffer.get()) : "Unknown error";
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <jvmti.h>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace znb_kit
+{
+    /*
+     * Caches jmethodID -> "package.Class.method" names. GetMethodName, GetMethodDeclaringClass and GetClassSignature
+     * each allocate, so profilers keep raw jmethodIDs on the hot path and symbolize here when reporting.
+     */
+    class jvmti_symbolizer
+    {
+        jvmtiEnv *jvmti;
+
+        mutable std::mutex mutex;
+        std::unordered_map<jmethodID, std::string> methods;
+
+    public:
+        explicit jvmti_symbolizer(jvmtiEnv *jvmti);
+
+        jvmti_symbolizer(const jvmti_symbolizer &) = delete;
+        jvmti_symbolizer &operator=(const jvmti_symbolizer &) = delete;
+
+        /*
+         * When called from an attached native thread, pass its JNIEnv so the declaring class reference can be released.
+         */
+        std::string resolve(jmethodID method, JNIEnv *jni = nullptr);
+
+        std::string resolve_class(jclass klass) const;
+
+        static std::string to_class_name(std::string_view signature);
+
+        [[nodiscard]] size_t size() const;
+
+        void clear();
+    };
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <jvmti.h>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ZNBKit/internal/spsc_ring.hpp"
+#include "ZNBKit/jvmti/jvmti_callbacks.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Associates Java objects with 64-bit native handles through JVMTI tags. Unlike a global ref a tag is not a GC
+     * root and costs nothing in the JNI tables; when a tagged object is collected ObjectFree reports its handle, which
+     * is queued lock-free from the GC thread and handed out in batches. A full ring spills into an unbounded list, so
+     * no free is lost to a burst of collections. Handles have to be non-zero, tags are per
+     * JVMTI environment and anything else tagging objects in the same environment will clash.
+     * Requires can_tag_objects and can_generate_object_free_events.
+     */
+    class object_tags final : public jvmti_listener
+    {
+    public:
+        using free_handler = std::function<void(std::span<const jlong>)>;
+
+        struct options
+        {
+            /*
+             * Without a handler freed handles wait for drain_freed().
+             */
+            free_handler on_freed;
+
+            std::chrono::milliseconds interval{100};
+            size_t batch = 1024;
+        };
+
+    private:
+        jvmtiEnv *jvmti;
+        bool running = false;
+
+        struct overflow_node
+        {
+            jlong handle;
+            overflow_node *next;
+        };
+
+        thread_rings<jlong, 8192> freed;
+
+        /*
+         * Treiber stack the consumer takes over whole, so nodes are never touched by a producer once pushed.
+         */
+        std::atomic<overflow_node *> overflow{nullptr};
+        std::atomic_size_t dropped{0};
+
+        std::mutex drain_mutex;
+
+        std::thread worker;
+        std::atomic_bool working{false};
+
+        std::mutex wake_mutex;
+        std::condition_variable wake;
+
+        void run(options options);
+
+    public:
+        explicit object_tags(jvmtiEnv *jvmti);
+
+        object_tags(const object_tags &) = delete;
+        object_tags &operator=(const object_tags &) = delete;
+
+        ~object_tags() override;
+
+        void start(const options &options);
+
+        void start()
+        {
+            start(options{});
+        }
+
+        void stop();
+
+        void associate(jobject object, jlong handle);
+
+        /*
+         * Removes the association without a free notification.
+         */
+        void dissociate(jobject object);
+
+        std::optional<jlong> get(jobject object) const;
+
+        /*
+         * Live objects carrying any of the handles, as local refs owned by the caller.
+         */
+        std::vector<std::pair<jobject, jlong>> find(std::span<const jlong> handles) const;
+
+        /*
+         * Hands out freed handles in batches of at most `batch`. Returns the number of handles delivered.
+         */
+        size_t drain_freed(const free_handler &handler, size_t batch = 1024);
+
+        /*
+         * Free notifications lost because the overflow list could not allocate; the native state behind them has to be
+         * reclaimed another way.
+         */
+        [[nodiscard]] size_t get_dropped() const
+        {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        void on_object_free(jvmtiEnv *, jlong tag) override;
+    };
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <jvmti.h>
+#include <mutex>
+#include <optional>
+
+#include "ZNBKit/jvmti/jvmti_callbacks.hpp"
+#include "ZNBKit/jvmti/jvmti_symbolizer.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Writes JIT code locations to /tmp/perf-<pid>.map ("start size name" in hex, one line per blob) so that Linux perf
+     * can symbolize compiled Java frames. Lines are appended and flushed as methods are compiled; code that existed
+     * before start() is replayed through GenerateEvents. The map format has no removal record, so unloads only count.
+     * Requires can_generate_compiled_method_load_events.
+     */
+    class perf_map_writer final : public jvmti_listener
+    {
+    public:
+        struct options
+        {
+            /*
+             * Defaults to /tmp/perf-<pid>.map, the location perf looks at.
+             */
+            std::optional<std::filesystem::path> path;
+
+            bool include_stubs = true;
+        };
+
+    private:
+        jvmtiEnv *jvmti;
+        jvmti_symbolizer symbolizer;
+
+        bool running = false;
+
+        std::mutex stream_mutex;
+        std::ofstream stream;
+        std::filesystem::path path;
+
+        std::atomic_size_t entries{0};
+        std::atomic_size_t unloaded{0};
+
+        void write(const void *address, jint size, const std::string &name);
+
+    public:
+        explicit perf_map_writer(jvmtiEnv *jvmti);
+
+        perf_map_writer(const perf_map_writer &) = delete;
+        perf_map_writer &operator=(const perf_map_writer &) = delete;
+
+        ~perf_map_writer() override;
+
+        void start(const options &options);
+
+        void start()
+        {
+            start(options{});
+        }
+
+        void stop();
+
+        [[nodiscard]] const std::filesystem::path &get_path() const
+        {
+            return path;
+        }
+
+        [[nodiscard]] size_t get_entries() const
+        {
+            return entries.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t get_unloaded() const
+        {
+            return unloaded.load(std::memory_order_relaxed);
+        }
+
+        void on_compiled_method_load(jvmtiEnv *, jmethodID method, jint code_size, const void *code_addr, jint,
+                                     const jvmtiAddrLocationMap *, const void *) override;
+
+        void on_compiled_method_unload(jvmtiEnv *, jmethodID, const void *) override;
+
+        void on_dynamic_code_generated(jvmtiEnv *, const char *name, const void *address, jint length) override;
+    };
+}
@@ -0,0 +1,164 @@
+#include "ZNBKit/jvmti/allocation_sampler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ranges>
+#include <stdexcept>
+
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+namespace znb_kit
+{
+    allocation_sampler::allocation_sampler(jvmtiEnv *jvmti): jvmti(jvmti), symbolizer(jvmti)
+    {
+    }
+
+    allocation_sampler::~allocation_sampler()
+    {
+        stop();
+    }
+
+    void allocation_sampler::start(const options &options)
+    {
+        if (running)
+        {
+            return;
+        }
+
+        if (options.interval < 0 || options.max_depth <= 0)
+        {
+            throw std::invalid_argument("Sampling interval cannot be negative and stack depth has to be positive");
+        }
+
+        max_depth = std::min<jint>(options.max_depth, max_frames);
+
+        if (const auto error = jvmti->SetHeapSamplingInterval(options.interval); error != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to set heap sampling interval: " + get_error_name(jvmti, error));
+        }
+
+        jvmti_callbacks::subscribe(jvmti, this, {JVMTI_EVENT_SAMPLED_OBJECT_ALLOC, JVMTI_EVENT_THREAD_END});
+        running = true;
+    }
+
+    void allocation_sampler::stop()
+    {
+        if (!running)
+        {
+            return;
+        }
+
+        jvmti_callbacks::unsubscribe(jvmti, this);
+        running = false;
+    }
+
+    void allocation_sampler::on_sampled_object_alloc(jvmtiEnv *, JNIEnv *, jthread, jobject, const jclass klass, const jlong size)
+    {
+        sample record;
+        record.size = size;
+        record.klass[0] = '\0';
+
+        char *signature = nullptr;
+
+        if (jvmti->GetClassSignature(klass, &signature, nullptr) == JVMTI_ERROR_NONE && signature != nullptr)
+        {
+            std::strncpy(record.klass, signature, max_klass_length - 1);
+            record.klass[max_klass_length - 1] = '\0';
+
+            jvmti->Deallocate(reinterpret_cast<unsigned char *>(signature));
+        }
+
+        jvmtiFrameInfo frames[max_frames];
+        jint depth = 0;
+
+        if (jvmti->GetStackTrace(nullptr, 0, max_depth, frames, &depth) != JVMTI_ERROR_NONE)
+        {
+            depth = 0;
+        }
+
+        record.depth = depth;
+
+        for (jint i = 0; i < depth; ++i)
+        {
+            record.frames[i] = frames[i].method;
+        }
+
+        rings.push(record);
+    }
+
+    void allocation_sampler::on_thread_end(jvmtiEnv *, JNIEnv *, jthread)
+    {
+        rings.release_current();
+    }
+
+    void allocation_sampler::collect()
+    {
+        rings.drain([this](const sample &record) {
+            std::string key(record.klass);
+            key.append(reinterpret_cast<const char *>(record.frames), record.depth * sizeof(jmethodID));
+
+            auto &aggregate = aggregates[key];
+
+            if (aggregate.samples == 0)
+            {
+                aggregate.klass = jvmti_symbolizer::to_class_name(record.klass);
+                aggregate.frames.assign(record.frames, record.frames + record.depth);
+            }
+
+            ++aggregate.samples;
+            aggregate.bytes += record.size;
+        });
+    }
+
+    void allocation_sampler::reset()
+    {
+        std::lock_guard lock(aggregates_mutex);
+
+        collect();
+        aggregates.clear();
+    }
+
+    std::vector<allocation_sampler::site> allocation_sampler::top_sites(const size_t count, JNIEnv *jni)
+    {
+        std::vector<const aggregate *> ordered;
+        std::vector<site> sites;
+
+        std::lock_guard lock(aggregates_mutex);
+
+        collect();
+
+        ordered.reserve(aggregates.size());
+
+        for (const auto &aggregate : aggregates | std::views::values)
+        {
+            ordered.push_back(&aggregate);
+        }
+
+        const size_t limit = std::min(count, ordered.size());
+
+        std::partial_sort(ordered.begin(), ordered.begin() + static_cast<ptrdiff_t>(limit), ordered.end(), [](const aggregate *a, const aggregate *b) {
+            return a->bytes > b->bytes;
+        });
+
+        sites.reserve(limit);
+
+        for (size_t i = 0; i < limit; ++i)
+        {
+            const auto &aggregate = *ordered[i];
+
+            site site;
+            site.klass = aggregate.klass;
+            site.samples = aggregate.samples;
+            site.bytes = aggregate.bytes;
+
+            for (const auto method : aggregate.frames)
+            {
+                site.stack.push_back(symbolizer.resolve(method, jni));
+            }
+
+            sites.push_back(std::move(site));
+        }
+
+        return sites;
+    }
+}
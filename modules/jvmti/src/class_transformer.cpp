@@ -0,0 +1,354 @@
+#include "ZNBKit/jvmti/class_transformer.hpp"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+namespace
+{
+    constexpr uint64_t fnv_offset = 0xcbf29ce484222325ULL;
+    constexpr uint64_t fnv_prime = 0x100000001b3ULL;
+
+    uint64_t mix(uint64_t key, const std::span<const unsigned char> bytes)
+    {
+        for (const unsigned char c : bytes)
+        {
+            key ^= c;
+            key *= fnv_prime;
+        }
+
+        return key;
+    }
+
+    uint64_t mix(const uint64_t key, const std::string_view value)
+    {
+        return mix(key, std::span(reinterpret_cast<const unsigned char *>(value.data()), value.size()));
+    }
+
+    constexpr std::string_view untouched_index = "untouched.index";
+}
+
+namespace znb_kit
+{
+    class_transform_pipeline::class_transform_pipeline(jvmtiEnv *jvmti): jvmti(jvmti)
+    {
+    }
+
+    class_transform_pipeline::~class_transform_pipeline()
+    {
+        stop();
+    }
+
+    void class_transform_pipeline::add(std::shared_ptr<class_transformer> transformer)
+    {
+        VAR_CHECK(transformer);
+
+        if (running)
+        {
+            throw std::logic_error("Transformers cannot be added to a running pipeline");
+        }
+
+        auto added = std::make_unique<entry>();
+        added->transformer = std::move(transformer);
+
+        entries.push_back(std::move(added));
+    }
+
+    void class_transform_pipeline::start(const options &options)
+    {
+        if (running)
+        {
+            return;
+        }
+
+        chain_key = fnv_offset;
+
+        for (const auto &entry : entries)
+        {
+            chain_key = mix(chain_key, std::format("{}@{};", entry->transformer->get_name(), entry->transformer->get_version()));
+        }
+
+        cache_directory = options.cache_directory;
+
+        if (cache_directory)
+        {
+            std::error_code error;
+            std::filesystem::create_directories(*cache_directory, error);
+
+            if (error)
+            {
+                debug_print_cerr("[TRANSFORM] Cache directory is not usable, caching in memory only: " + error.message());
+                cache_directory.reset();
+            }
+        }
+
+        load_untouched_index();
+
+        jvmti_callbacks::subscribe(jvmti, this, {JVMTI_EVENT_CLASS_FILE_LOAD_HOOK});
+        running = true;
+    }
+
+    void class_transform_pipeline::stop()
+    {
+        if (!running)
+        {
+            return;
+        }
+
+        jvmti_callbacks::unsubscribe(jvmti, this);
+        running = false;
+    }
+
+    std::string class_transform_pipeline::cache_key::to_string() const
+    {
+        return std::format("{:016x}:{}", hash, name);
+    }
+
+    void class_transform_pipeline::load_untouched_index()
+    {
+        if (!cache_directory)
+        {
+            return;
+        }
+
+        std::ifstream in(*cache_directory / untouched_index);
+
+        std::lock_guard lock(cache_mutex);
+
+        for (std::string line; std::getline(in, line);)
+        {
+            /*
+             * '<hash> <input size> <class name>'; the name goes last as it may contain spaces.
+             */
+            const auto first = line.find(' ');
+            const auto second = first == std::string::npos ? std::string::npos : line.find(' ', first + 1);
+
+            if (second == std::string::npos)
+            {
+                continue;
+            }
+
+            try
+            {
+                const cache_key key{line.substr(second + 1), std::stoull(line.substr(0, first), nullptr, 16), std::stoull(line.substr(first + 1, second - first - 1))};
+                cache.emplace(key.to_string(), cached_entry{key.size, std::nullopt});
+            }
+            catch (const std::exception &)
+            {
+                debug_print_cerr("[TRANSFORM] Skipping malformed cache index line: " + line);
+            }
+        }
+    }
+
+    std::optional<class_transform_pipeline::cached_result> class_transform_pipeline::load_cached(const cache_key &key)
+    {
+        const auto name = key.to_string();
+
+        {
+            std::lock_guard lock(cache_mutex);
+
+            if (const auto it = cache.find(name); it != cache.end() && it->second.size == key.size)
+            {
+                return std::make_optional(it->second.result);
+            }
+        }
+
+        if (!cache_directory)
+        {
+            return std::nullopt;
+        }
+
+        /*
+         * '<class name>\n<input size>\n' followed by the transformed bytes. A file written for another class that
+         * happens to share the hash is ignored.
+         */
+        std::ifstream file(*cache_directory / std::format("{:016x}.class", key.hash), std::ios::binary);
+
+        std::string stored_name;
+        std::string stored_size;
+
+        if (!file || !std::getline(file, stored_name) || !std::getline(file, stored_size) ||
+            stored_name != key.name || stored_size != std::to_string(key.size))
+        {
+            return std::nullopt;
+        }
+
+        cached_result result(std::in_place, std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        if (result->empty())
+        {
+            return std::nullopt;
+        }
+
+        std::lock_guard lock(cache_mutex);
+        cache.insert_or_assign(name, cached_entry{key.size, result});
+
+        return std::make_optional(std::move(result));
+    }
+
+    void class_transform_pipeline::store_cached(const cache_key &key, const cached_result &result)
+    {
+        {
+            std::lock_guard lock(cache_mutex);
+
+            cache.insert_or_assign(key.to_string(), cached_entry{key.size, result});
+
+            /*
+             * Appending under the mutex keeps lines from concurrent loads in this process whole.
+             */
+            if (cache_directory && !result)
+            {
+                if (std::ofstream index(*cache_directory / untouched_index, std::ios::app); index)
+                {
+                    index << std::format("{:016x} {} {}\n", key.hash, key.size, key.name);
+                }
+            }
+        }
+
+        if (!cache_directory || !result)
+        {
+            return;
+        }
+
+        /*
+         * Written under a temporary name and renamed, so a concurrent start never reads a half-written class.
+         */
+        const auto target = *cache_directory / std::format("{:016x}.class", key.hash);
+        auto temporary = target;
+        temporary += ".tmp";
+
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+
+            file << key.name << '\n' << key.size << '\n';
+            file.write(reinterpret_cast<const char *>(result->data()), static_cast<std::streamsize>(result->size()));
+
+            if (!file)
+            {
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, target, error);
+    }
+
+    class_transform_pipeline::cached_result class_transform_pipeline::run_chain(const std::string_view class_name, const std::span<const unsigned char> bytes)
+    {
+        cached_result current;
+
+        for (const auto &entry : entries)
+        {
+            auto &transformer = *entry->transformer;
+
+            if (!transformer.accepts(class_name))
+            {
+                continue;
+            }
+
+            const auto input = current ? std::span<const unsigned char>(*current) : bytes;
+            const auto started = std::chrono::steady_clock::now();
+
+            auto output = transformer.transform(class_name, input);
+
+            entry->time.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count(),
+                                  std::memory_order_relaxed);
+            entry->invocations.fetch_add(1, std::memory_order_relaxed);
+
+            if (output && !output->empty())
+            {
+                entry->transformed.fetch_add(1, std::memory_order_relaxed);
+                current = std::move(output);
+            }
+        }
+
+        return current;
+    }
+
+    void class_transform_pipeline::on_class_file_load(jvmtiEnv *, JNIEnv *, jclass, jobject, const char *name, jobject,
+                                                      const jint class_data_len, const unsigned char *class_data,
+                                                      jint *new_class_data_len, unsigned char **new_class_data)
+    {
+        /*
+         * Hidden classes and lambda forms come without a name and are not worth rewriting.
+         */
+        if (name == nullptr || class_data == nullptr || entries.empty())
+        {
+            return;
+        }
+
+        const std::span bytes(class_data, static_cast<size_t>(class_data_len));
+        const cache_key key{name, mix(mix(chain_key, std::string_view(name)), bytes), bytes.size()};
+
+        cached_result result;
+
+        try
+        {
+            if (auto cached = load_cached(key))
+            {
+                cache_hits.fetch_add(1, std::memory_order_relaxed);
+                result = std::move(*cached);
+            }
+            else
+            {
+                cache_misses.fetch_add(1, std::memory_order_relaxed);
+
+                result = run_chain(name, bytes);
+                store_cached(key, result);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            debug_print_cerr(std::format("[TRANSFORM] Transforming {} failed: {}", name, e.what()));
+
+            return;
+        }
+
+        if (!result)
+        {
+            return;
+        }
+
+        unsigned char *output = nullptr;
+
+        if (const auto error = jvmti->Allocate(static_cast<jlong>(result->size()), &output); error != JVMTI_ERROR_NONE)
+        {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            debug_print_cerr("[TRANSFORM] Allocate failed: " + get_error_name(jvmti, error));
+
+            return;
+        }
+
+        std::memcpy(output, result->data(), result->size());
+
+        *new_class_data_len = static_cast<jint>(result->size());
+        *new_class_data = output;
+    }
+
+    class_transform_pipeline::stats class_transform_pipeline::get_stats() const
+    {
+        stats result;
+        result.cache_hits = cache_hits.load(std::memory_order_relaxed);
+        result.cache_misses = cache_misses.load(std::memory_order_relaxed);
+        result.failures = failures.load(std::memory_order_relaxed);
+
+        for (const auto &entry : entries)
+        {
+            transformer_stats stats;
+            stats.name = entry->transformer->get_name();
+            stats.invocations = entry->invocations.load(std::memory_order_relaxed);
+            stats.transformed = entry->transformed.load(std::memory_order_relaxed);
+            stats.time = std::chrono::nanoseconds(entry->time.load(std::memory_order_relaxed));
+
+            result.transformers.push_back(std::move(stats));
+        }
+
+        return result;
+    }
+}
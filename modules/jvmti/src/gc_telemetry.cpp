@@ -0,0 +1,101 @@
+#include "ZNBKit/jvmti/gc_telemetry.hpp"
+
+namespace znb_kit
+{
+    gc_telemetry::gc_telemetry(jvmtiEnv *jvmti): jvmti(jvmti)
+    {
+    }
+
+    gc_telemetry::~gc_telemetry()
+    {
+        stop();
+    }
+
+    int64_t gc_telemetry::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void gc_telemetry::start()
+    {
+        if (running)
+        {
+            return;
+        }
+
+        jvmti_callbacks::subscribe(jvmti, this, {JVMTI_EVENT_GARBAGE_COLLECTION_START, JVMTI_EVENT_GARBAGE_COLLECTION_FINISH});
+        running = true;
+    }
+
+    void gc_telemetry::stop()
+    {
+        if (!running)
+        {
+            return;
+        }
+
+        jvmti_callbacks::unsubscribe(jvmti, this);
+        started_at.store(0, std::memory_order_release);
+
+        running = false;
+    }
+
+    void gc_telemetry::on_garbage_collection_start(jvmtiEnv *)
+    {
+        started_at.store(now(), std::memory_order_release);
+    }
+
+    void gc_telemetry::on_garbage_collection_finish(jvmtiEnv *)
+    {
+        const int64_t finished = now();
+        const int64_t started = started_at.exchange(0, std::memory_order_acq_rel);
+
+        finished_at.store(finished, std::memory_order_release);
+        collections.fetch_add(1, std::memory_order_relaxed);
+
+        /*
+         * A finish without a start happens when the listener was subscribed in the middle of a pause.
+         */
+        if (started != 0)
+        {
+            pauses.record(static_cast<uint64_t>(finished - started));
+        }
+    }
+
+    gc_telemetry::pause_snapshot gc_telemetry::snapshot(const bool reset)
+    {
+        pause_snapshot result;
+        result.histogram = pauses.read(reset);
+
+        const auto &histogram = result.histogram;
+
+        result.pauses = histogram.count;
+        result.total = std::chrono::nanoseconds(histogram.sum);
+        result.mean = std::chrono::nanoseconds(static_cast<int64_t>(histogram.mean()));
+        result.max = std::chrono::nanoseconds(histogram.max);
+
+        result.p50 = std::chrono::nanoseconds(histogram.percentile(50.0));
+        result.p90 = std::chrono::nanoseconds(histogram.percentile(90.0));
+        result.p99 = std::chrono::nanoseconds(histogram.percentile(99.0));
+        result.p999 = std::chrono::nanoseconds(histogram.percentile(99.9));
+
+        return result;
+    }
+
+    bool gc_telemetry::in_gc() const
+    {
+        return started_at.load(std::memory_order_acquire) != 0;
+    }
+
+    std::optional<std::chrono::nanoseconds> gc_telemetry::since_last_gc() const
+    {
+        const int64_t finished = finished_at.load(std::memory_order_acquire);
+
+        if (finished == 0)
+        {
+            return std::nullopt;
+        }
+
+        return std::chrono::nanoseconds(now() - finished);
+    }
+}
@@ -0,0 +1,255 @@
+#include "ZNBKit/jvmti/heap_census.hpp"
+
+#include <algorithm>
+#include <format>
+#include <ranges>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "ZNBKit/internal/util.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+namespace
+{
+    struct census_counters
+    {
+        std::vector<znb_kit::heap_census::class_usage> *classes;
+        znb_kit::heap_census::class_usage *unknown;
+    };
+
+    jint JNICALL count_object(const jlong class_tag, const jlong size, jlong *, jint, void *user_data)
+    {
+        const auto *counters = static_cast<census_counters *>(user_data);
+
+        auto &usage = class_tag > 0 && static_cast<size_t>(class_tag) <= counters->classes->size()
+            ? (*counters->classes)[class_tag - 1]
+            : *counters->unknown;
+
+        ++usage.instances;
+        usage.bytes += size;
+
+        return JVMTI_VISIT_OBJECTS;
+    }
+
+    /*
+     * Tags are per environment, so a throwaway environment keeps census tags apart from object_tags and anything else
+     * tagging in the caller's one. Disposing it drops every tag set during the census.
+     */
+    class census_environment
+    {
+        jvmtiEnv *jvmti = nullptr;
+
+    public:
+        explicit census_environment(JNIEnv *jni)
+        {
+            JavaVM *vm = nullptr;
+
+            if (jni->GetJavaVM(&vm) != JNI_OK || vm == nullptr || vm->GetEnv(reinterpret_cast<void **>(&jvmti), JVMTI_VERSION_1_2) != JNI_OK)
+            {
+                throw std::runtime_error("Failed to create a JVMTI environment for the heap census.");
+            }
+
+            jvmtiCapabilities capabilities = {};
+            capabilities.can_tag_objects = 1;
+
+            if (const auto error = jvmti->AddCapabilities(&capabilities); error != JVMTI_ERROR_NONE)
+            {
+                const auto name = znb_kit::get_error_name(jvmti, error);
+                jvmti->DisposeEnvironment();
+
+                throw std::runtime_error("Failed to enable object tagging for the heap census: " + name);
+            }
+        }
+
+        census_environment(const census_environment &) = delete;
+        census_environment &operator=(const census_environment &) = delete;
+
+        ~census_environment()
+        {
+            jvmti->DisposeEnvironment();
+        }
+
+        [[nodiscard]] jvmtiEnv *get() const
+        {
+            return jvmti;
+        }
+    };
+
+    /*
+     * Deletes the local refs returned by GetLoadedClasses, on the way out of a census that threw as well.
+     */
+    struct class_refs
+    {
+        JNIEnv *jni;
+        const jclass *classes;
+        jint count;
+
+        ~class_refs()
+        {
+            for (jint i = 0; i < count; ++i)
+            {
+                jni->DeleteLocalRef(classes[i]);
+            }
+        }
+    };
+}
+
+namespace znb_kit
+{
+    heap_census::heap_census(jvmtiEnv *jvmti): jvmti(jvmti), symbolizer(jvmti)
+    {
+    }
+
+    heap_census::snapshot heap_census::take(JNIEnv *jni, const bool collect_garbage)
+    {
+        VAR_CHECK(jni);
+
+        if (collect_garbage)
+        {
+            jvmti->ForceGarbageCollection();
+        }
+
+        jint class_count = 0;
+        jclass *raw_classes = nullptr;
+
+        if (const auto error = jvmti->GetLoadedClasses(&class_count, &raw_classes); error != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to get loaded classes: " + get_error_name(jvmti, error));
+        }
+
+        const jvmti_ptr<jclass> classes(raw_classes, {jvmti});
+        const class_refs refs{jni, classes.get(), class_count};
+
+        const census_environment census(jni);
+
+        snapshot result;
+        result.classes.resize(class_count);
+
+        for (jint i = 0; i < class_count; ++i)
+        {
+            result.classes[i].klass = symbolizer.resolve_class(classes.get()[i]);
+
+            if (const auto error = census.get()->SetTag(classes.get()[i], i + 1); error != JVMTI_ERROR_NONE)
+            {
+                throw std::runtime_error("Failed to tag class " + result.classes[i].klass + ": " + get_error_name(jvmti, error));
+            }
+        }
+
+        class_usage unknown{"[unknown]"};
+        census_counters counters{&result.classes, &unknown};
+
+        jvmtiHeapCallbacks callbacks = {};
+        callbacks.heap_iteration_callback = &count_object;
+
+        if (const auto error = census.get()->IterateThroughHeap(0, nullptr, &callbacks, &counters); error != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to iterate through heap: " + get_error_name(jvmti, error));
+        }
+
+        if (unknown.instances > 0)
+        {
+            result.classes.push_back(unknown);
+        }
+
+        /*
+         * The same name can appear for classes defined by different loaders, so merge them before reporting.
+         */
+        std::unordered_map<std::string, class_usage> merged;
+
+        for (auto &usage : result.classes)
+        {
+            if (usage.instances == 0)
+            {
+                continue;
+            }
+
+            auto &[klass, instances, bytes] = merged[usage.klass];
+            klass = usage.klass;
+            instances += usage.instances;
+            bytes += usage.bytes;
+
+            result.instances += usage.instances;
+            result.bytes += usage.bytes;
+        }
+
+        result.classes.clear();
+        result.classes.reserve(merged.size());
+
+        for (auto &usage : merged | std::views::values)
+        {
+            result.classes.push_back(std::move(usage));
+        }
+
+        std::ranges::sort(result.classes, [](const class_usage &a, const class_usage &b) {
+            return a.bytes > b.bytes;
+        });
+
+        result.taken_at = std::chrono::steady_clock::now();
+
+        return result;
+    }
+
+    std::vector<heap_census::difference> heap_census::diff(const snapshot &before, const snapshot &after)
+    {
+        std::unordered_map<std::string, difference> differences;
+
+        for (const auto &[klass, instances, bytes] : after.classes)
+        {
+            auto &entry = differences[klass];
+            entry.klass = klass;
+            entry.instances += instances;
+            entry.bytes += bytes;
+        }
+
+        for (const auto &[klass, instances, bytes] : before.classes)
+        {
+            auto &entry = differences[klass];
+            entry.klass = klass;
+            entry.instances -= instances;
+            entry.bytes -= bytes;
+        }
+
+        std::vector<difference> result;
+
+        for (auto &entry : differences | std::views::values)
+        {
+            if (entry.instances != 0 || entry.bytes != 0)
+            {
+                result.push_back(std::move(entry));
+            }
+        }
+
+        std::ranges::sort(result, [](const difference &a, const difference &b) {
+            return std::abs(a.bytes) > std::abs(b.bytes);
+        });
+
+        return result;
+    }
+
+    std::string heap_census::snapshot::to_json() const
+    {
+        std::string json = std::format("{{\"instances\":{},\"bytes\":{},\"classes\":[", instances, bytes);
+
+        for (size_t i = 0; i < classes.size(); ++i)
+        {
+            json += std::format("{}{{\"class\":\"{}\",\"instances\":{},\"bytes\":{}}}",
+                i == 0 ? "" : ",", escape_json(classes[i].klass), classes[i].instances, classes[i].bytes);
+        }
+
+        return json + "]}";
+    }
+
+    std::string heap_census::to_json(const std::vector<difference> &differences)
+    {
+        std::string json = "[";
+
+        for (size_t i = 0; i < differences.size(); ++i)
+        {
+            json += std::format("{}{{\"class\":\"{}\",\"instances\":{},\"bytes\":{}}}",
+                i == 0 ? "" : ",", escape_json(differences[i].klass), differences[i].instances, differences[i].bytes);
+        }
+
+        return json + "]";
+    }
+}
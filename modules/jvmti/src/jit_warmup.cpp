@@ -0,0 +1,386 @@
+#include "ZNBKit/jvmti/jit_warmup.hpp"
+
+#include <format>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/local_ref.hpp"
+#include "ZNBKit/internal/timeline.hpp"
+#include "ZNBKit/internal/util.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+#define WARMUP_INVOKE(TYPE) \
+    if (target.is_static) \
+    { \
+        jni->CallStatic##TYPE##MethodA(target.owner, target.method, arguments.data()); \
+    } \
+    else \
+    { \
+        jni->Call##TYPE##MethodA(target.instance, target.method, arguments.data()); \
+    }
+
+namespace
+{
+    int64_t get_timestamp()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*
+     * HotSpot flag value through HotSpotDiagnosticMXBean, empty when the bean or the flag is not available.
+     */
+    std::optional<std::string> get_vm_option(JNIEnv *jni, const char *name)
+    {
+        const auto find = [jni](const char *klass_name) {
+            znb_kit::local_class klass(jni, jni->FindClass(klass_name));
+            jni->ExceptionClear();
+
+            return klass;
+        };
+
+        const auto factory = find("java/lang/management/ManagementFactory");
+        const auto bean_klass = find("com/sun/management/HotSpotDiagnosticMXBean");
+        const auto option_klass = find("com/sun/management/VMOption");
+
+        if (!factory || !bean_klass || !option_klass)
+        {
+            return std::nullopt;
+        }
+
+        const auto get_bean = jni->GetStaticMethodID(factory.get(), "getPlatformMXBean", "(Ljava/lang/Class;)Ljava/lang/management/PlatformManagedObject;");
+        const auto get_option = get_bean != nullptr ? jni->GetMethodID(bean_klass.get(), "getVMOption", "(Ljava/lang/String;)Lcom/sun/management/VMOption;") : nullptr;
+        const auto get_value = get_option != nullptr ? jni->GetMethodID(option_klass.get(), "getValue", "()Ljava/lang/String;") : nullptr;
+
+        if (get_value == nullptr)
+        {
+            jni->ExceptionClear();
+            return std::nullopt;
+        }
+
+        const znb_kit::local_object bean(jni, jni->CallStaticObjectMethod(factory.get(), get_bean, bean_klass.get()));
+
+        if (jni->ExceptionCheck() || !bean)
+        {
+            jni->ExceptionClear();
+            return std::nullopt;
+        }
+
+        const znb_kit::local_string option_name(jni, jni->NewStringUTF(name));
+
+        if (jni->ExceptionCheck() || !option_name)
+        {
+            jni->ExceptionClear();
+            return std::nullopt;
+        }
+
+        const znb_kit::local_object option(jni, jni->CallObjectMethod(bean.get(), get_option, option_name.get()));
+
+        if (jni->ExceptionCheck() || !option)
+        {
+            jni->ExceptionClear();
+            return std::nullopt;
+        }
+
+        const znb_kit::local_string value(jni, static_cast<jstring>(jni->CallObjectMethod(option.get(), get_value)));
+
+        if (jni->ExceptionCheck() || !value)
+        {
+            jni->ExceptionClear();
+            return std::nullopt;
+        }
+
+        return znb_kit::get_string(jni, value.get());
+    }
+}
+
+namespace znb_kit
+{
+    jit_warmup::jit_warmup(jvmtiEnv *jvmti): jvmti(jvmti)
+    {
+        if (jvmti == nullptr)
+        {
+            throw std::invalid_argument("JVMTI environment cannot be null");
+        }
+    }
+
+    void jit_warmup::on_compiled_method_load(jvmtiEnv *, const jmethodID method, jint, const void *, jint, const jvmtiAddrLocationMap *, const void *)
+    {
+        const auto it = indices.find(method);
+
+        if (it == indices.end())
+        {
+            return;
+        }
+
+        auto &state = states[it->second];
+
+        if (replaying_thread.load(std::memory_order_acquire) == std::this_thread::get_id())
+        {
+            state.replayed.store(true, std::memory_order_relaxed);
+        }
+        else
+        {
+            int64_t unset = 0;
+            state.first_compiled_at.compare_exchange_strong(unset, get_timestamp(), std::memory_order_relaxed);
+        }
+
+        state.compilations.fetch_add(1, std::memory_order_release);
+    }
+
+    bool jit_warmup::is_single_tier(JNIEnv *jni)
+    {
+        /*
+         * Flags are fixed for the life of the VM, so the management lookup only happens once.
+         */
+        static const bool single_tier = [jni] {
+            if (get_vm_option(jni, "TieredCompilation") == "false")
+            {
+                return true;
+            }
+
+            const auto stop_level = get_vm_option(jni, "TieredStopAtLevel");
+
+            return stop_level.has_value() && !stop_level->empty() && std::stoi(*stop_level) < 4;
+        }();
+
+        return single_tier;
+    }
+
+    std::vector<jvalue> jit_warmup::synthesize_arguments(JNIEnv *jni, const std::string &signature, std::vector<jobject> &locals)
+    {
+        std::vector<jvalue> arguments;
+
+        const size_t end = signature.find(')');
+
+        if (!signature.starts_with('(') || end == std::string::npos)
+        {
+            throw std::invalid_argument("Invalid method signature: " + signature);
+        }
+
+        for (size_t i = 1; i < end; ++i)
+        {
+            jvalue value = {};
+
+            switch (signature[i])
+            {
+            case 'L':
+            {
+                const size_t type_end = signature.find(';', i);
+
+                if (signature.compare(i, type_end - i + 1, "Ljava/lang/String;") == 0)
+                {
+                    value.l = jni->NewStringUTF("");
+                    locals.push_back(value.l);
+                }
+
+                i = type_end;
+                break;
+            }
+            case '[':
+                while (signature[i] == '[')
+                {
+                    ++i;
+                }
+
+                if (signature[i] == 'L')
+                {
+                    i = signature.find(';', i);
+                }
+                break;
+            default:
+                break;
+            }
+
+            arguments.push_back(value);
+        }
+
+        return arguments;
+    }
+
+    bool jit_warmup::invoke(JNIEnv *jni, const target &target, const std::vector<jvalue> &arguments)
+    {
+        switch (target.signature[target.signature.find(')') + 1])
+        {
+        case 'V':
+            WARMUP_INVOKE(Void)
+            break;
+        case 'Z':
+            WARMUP_INVOKE(Boolean)
+            break;
+        case 'B':
+            WARMUP_INVOKE(Byte)
+            break;
+        case 'C':
+            WARMUP_INVOKE(Char)
+            break;
+        case 'S':
+            WARMUP_INVOKE(Short)
+            break;
+        case 'I':
+            WARMUP_INVOKE(Int)
+            break;
+        case 'J':
+            WARMUP_INVOKE(Long)
+            break;
+        case 'F':
+            WARMUP_INVOKE(Float)
+            break;
+        case 'D':
+            WARMUP_INVOKE(Double)
+            break;
+        default:
+        {
+            const auto result = target.is_static
+                ? jni->CallStaticObjectMethodA(target.owner, target.method, arguments.data())
+                : jni->CallObjectMethodA(target.instance, target.method, arguments.data());
+
+            if (result != nullptr)
+            {
+                jni->DeleteLocalRef(result);
+            }
+            break;
+        }
+        }
+
+        if (jni->ExceptionCheck())
+        {
+            jni->ExceptionClear();
+            return false;
+        }
+
+        return true;
+    }
+
+    std::vector<jit_warmup::target_report> jit_warmup::run(JNIEnv *jni, const std::vector<target> &targets, const options &options)
+    {
+        VAR_CHECK(jni);
+
+        std::vector<target_report> reports(targets.size());
+        std::vector<std::vector<jvalue>> arguments(targets.size());
+        std::vector<jobject> locals;
+
+        indices.clear();
+        states = std::make_unique<progress[]>(targets.size());
+
+        const bool single_tier = is_single_tier(jni);
+
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            const auto &target = targets[i];
+
+            VAR_CHECK(target.method);
+
+            if (target.is_static ? target.owner == nullptr : target.instance == nullptr)
+            {
+                throw std::invalid_argument("Warm-up target needs an owner for static and an instance for virtual methods");
+            }
+
+            indices[target.method] = i;
+            arguments[i] = target.arguments.has_value() ? target.arguments.value() : synthesize_arguments(jni, target.signature, locals);
+
+            char *raw_name = nullptr;
+            jvmti->GetMethodName(target.method, &raw_name, nullptr, nullptr);
+            const jvmti_ptr<char> name(raw_name, {jvmti});
+
+            reports[i].name = (name ? std::string(name.get()) : "unknown") + target.signature;
+        }
+
+        timeline::scope phase("jit_warmup");
+
+        jvmti_callbacks::subscribe(jvmti, this, {JVMTI_EVENT_COMPILED_METHOD_LOAD});
+
+        /*
+         * Replays CompiledMethodLoad for code that was installed before we subscribed.
+         */
+        replaying_thread.store(std::this_thread::get_id(), std::memory_order_release);
+
+        if (const auto error = jvmti->GenerateEvents(JVMTI_EVENT_COMPILED_METHOD_LOAD); error != JVMTI_ERROR_NONE)
+        {
+            debug_print_cerr("[JIT] GenerateEvents failed: " + get_error_name(jvmti, error));
+        }
+
+        replaying_thread.store({}, std::memory_order_release);
+
+        const int64_t settle = std::chrono::duration_cast<std::chrono::nanoseconds>(options.settle).count();
+
+        const auto started = std::chrono::steady_clock::now();
+        const auto deadline = started + options.budget;
+
+        size_t reached = 0;
+
+        while (true)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            bool pending = false;
+
+            for (size_t i = 0; i < targets.size(); ++i)
+            {
+                auto &report = reports[i];
+
+                if (report.reached)
+                {
+                    continue;
+                }
+
+                const auto &state = states[i];
+
+                report.compilations = state.compilations.load(std::memory_order_acquire);
+                report.precompiled = state.replayed.load(std::memory_order_relaxed);
+
+                const int64_t first_compiled_at = state.first_compiled_at.load(std::memory_order_relaxed);
+
+                const bool done = report.precompiled ||
+                                  report.compilations >= 2 ||
+                                  (report.compilations == 1 && (single_tier || get_timestamp() - first_compiled_at >= settle));
+
+                if (done)
+                {
+                    report.reached = true;
+                    report.time_to_reach = now - started;
+
+                    ++reached;
+                    continue;
+                }
+
+                pending = true;
+
+                if (now >= deadline)
+                {
+                    continue;
+                }
+
+                for (size_t b = 0; b < options.batch; ++b)
+                {
+                    if (!invoke(jni, targets[i], arguments[i]))
+                    {
+                        ++report.exceptions;
+                    }
+                }
+
+                report.invocations += options.batch;
+            }
+
+            if (!pending || now >= deadline)
+            {
+                break;
+            }
+        }
+
+        jvmti_callbacks::unsubscribe(jvmti, this);
+
+        for (const auto local : locals)
+        {
+            jni->DeleteLocalRef(local);
+        }
+
+        phase.set_count(reached);
+
+        for (const auto &report : reports)
+        {
+            debug_print(std::format("[JIT] {}: {} invocations, {} compilations, {}", report.name, report.invocations, report.compilations,
+                report.reached ? std::format("ready after {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(report.time_to_reach).count()) : "budget exhausted"));
+        }
+
+        return reports;
+    }
+}
@@ -0,0 +1,276 @@
+#include "ZNBKit/jvmti/jvmti_callbacks.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+namespace znb_kit
+{
+    std::array<jvmti_callbacks::slot, jvmti_callbacks::max_listeners> jvmti_callbacks::slots;
+    std::array<size_t, jvmti_callbacks::event_count> jvmti_callbacks::event_references{};
+
+    std::mutex jvmti_callbacks::mutex;
+    jvmtiEnv *jvmti_callbacks::installed = nullptr;
+
+    struct jvmti_trampolines
+    {
+        static void JNICALL vm_death(jvmtiEnv *jvmti, JNIEnv *jni)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_VM_DEATH, [&](jvmti_listener *listener) {
+                listener->on_vm_death(jvmti, jni);
+            });
+        }
+
+        static void JNICALL thread_start(jvmtiEnv *jvmti, JNIEnv *jni, jthread thread)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_THREAD_START, [&](jvmti_listener *listener) {
+                listener->on_thread_start(jvmti, jni, thread);
+            });
+        }
+
+        static void JNICALL thread_end(jvmtiEnv *jvmti, JNIEnv *jni, jthread thread)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_THREAD_END, [&](jvmti_listener *listener) {
+                listener->on_thread_end(jvmti, jni, thread);
+            });
+        }
+
+        static void JNICALL class_file_load(jvmtiEnv *jvmti, JNIEnv *jni, jclass being_redefined, jobject loader, const char *name,
+                                            jobject protection_domain, jint length, const unsigned char *data,
+                                            jint *new_length, unsigned char **new_data)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_CLASS_FILE_LOAD_HOOK, [&](jvmti_listener *listener) {
+                listener->on_class_file_load(jvmti, jni, being_redefined, loader, name, protection_domain, length, data, new_length, new_data);
+            });
+        }
+
+        static void JNICALL class_load(jvmtiEnv *jvmti, JNIEnv *jni, jthread thread, jclass klass)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_CLASS_LOAD, [&](jvmti_listener *listener) {
+                listener->on_class_load(jvmti, jni, thread, klass);
+            });
+        }
+
+        static void JNICALL class_prepare(jvmtiEnv *jvmti, JNIEnv *jni, jthread thread, jclass klass)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_CLASS_PREPARE, [&](jvmti_listener *listener) {
+                listener->on_class_prepare(jvmti, jni, thread, klass);
+            });
+        }
+
+        static void JNICALL compiled_method_load(jvmtiEnv *jvmti, jmethodID method, jint code_size, const void *code_address,
+                                                 jint map_length, const jvmtiAddrLocationMap *map, const void *compile_info)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_COMPILED_METHOD_LOAD, [&](jvmti_listener *listener) {
+                listener->on_compiled_method_load(jvmti, method, code_size, code_address, map_length, map, compile_info);
+            });
+        }
+
+        static void JNICALL compiled_method_unload(jvmtiEnv *jvmti, jmethodID method, const void *code_address)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_COMPILED_METHOD_UNLOAD, [&](jvmti_listener *listener) {
+                listener->on_compiled_method_unload(jvmti, method, code_address);
+            });
+        }
+
+        static void JNICALL dynamic_code_generated(jvmtiEnv *jvmti, const char *name, const void *address, jint length)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_DYNAMIC_CODE_GENERATED, [&](jvmti_listener *listener) {
+                listener->on_dynamic_code_generated(jvmti, name, address, length);
+            });
+        }
+
+        static void JNICALL garbage_collection_start(jvmtiEnv *jvmti)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_GARBAGE_COLLECTION_START, [&](jvmti_listener *listener) {
+                listener->on_garbage_collection_start(jvmti);
+            });
+        }
+
+        static void JNICALL garbage_collection_finish(jvmtiEnv *jvmti)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_GARBAGE_COLLECTION_FINISH, [&](jvmti_listener *listener) {
+                listener->on_garbage_collection_finish(jvmti);
+            });
+        }
+
+        static void JNICALL object_free(jvmtiEnv *jvmti, jlong tag)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_OBJECT_FREE, [&](jvmti_listener *listener) {
+                listener->on_object_free(jvmti, tag);
+            });
+        }
+
+        static void JNICALL sampled_object_alloc(jvmtiEnv *jvmti, JNIEnv *jni, jthread thread, jobject object, jclass klass, jlong size)
+        {
+            jvmti_callbacks::dispatch(JVMTI_EVENT_SAMPLED_OBJECT_ALLOC, [&](jvmti_listener *listener) {
+                listener->on_sampled_object_alloc(jvmti, jni, thread, object, klass, size);
+            });
+        }
+    };
+
+    void jvmti_callbacks::install(jvmtiEnv *jvmti)
+    {
+        if (installed == jvmti)
+        {
+            return;
+        }
+
+        if (installed != nullptr)
+        {
+            throw std::runtime_error("JVMTI callbacks are already installed on another environment");
+        }
+
+        jvmtiEventCallbacks callbacks = {};
+
+        callbacks.VMDeath = &jvmti_trampolines::vm_death;
+        callbacks.ThreadStart = &jvmti_trampolines::thread_start;
+        callbacks.ThreadEnd = &jvmti_trampolines::thread_end;
+        callbacks.ClassFileLoadHook = &jvmti_trampolines::class_file_load;
+        callbacks.ClassLoad = &jvmti_trampolines::class_load;
+        callbacks.ClassPrepare = &jvmti_trampolines::class_prepare;
+        callbacks.CompiledMethodLoad = &jvmti_trampolines::compiled_method_load;
+        callbacks.CompiledMethodUnload = &jvmti_trampolines::compiled_method_unload;
+        callbacks.DynamicCodeGenerated = &jvmti_trampolines::dynamic_code_generated;
+        callbacks.GarbageCollectionStart = &jvmti_trampolines::garbage_collection_start;
+        callbacks.GarbageCollectionFinish = &jvmti_trampolines::garbage_collection_finish;
+        callbacks.ObjectFree = &jvmti_trampolines::object_free;
+        callbacks.SampledObjectAlloc = &jvmti_trampolines::sampled_object_alloc;
+
+        if (const auto error = jvmti->SetEventCallbacks(&callbacks, sizeof(callbacks)); error != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to set JVMTI event callbacks: " + get_error_name(jvmti, error));
+        }
+
+        installed = jvmti;
+    }
+
+    void jvmti_callbacks::set_event(jvmtiEnv *jvmti, const jvmtiEvent event, const bool enable)
+    {
+        auto &references = event_references[event - JVMTI_MIN_EVENT_TYPE_VAL];
+
+        if (enable && references++ > 0)
+        {
+            return;
+        }
+
+        if (!enable && (references == 0 || --references > 0))
+        {
+            return;
+        }
+
+        if (const auto error = jvmti->SetEventNotificationMode(enable ? JVMTI_ENABLE : JVMTI_DISABLE, event, nullptr); error != JVMTI_ERROR_NONE)
+        {
+            if (enable)
+            {
+                --references;
+            }
+
+            throw std::runtime_error("Failed to " + std::string(enable ? "enable" : "disable") + " JVMTI event " +
+                                     std::to_string(event) + ": " + get_error_name(jvmti, error));
+        }
+    }
+
+    void jvmti_callbacks::subscribe(jvmtiEnv *jvmti, jvmti_listener *listener, const std::vector<jvmtiEvent> &events)
+    {
+        if (jvmti == nullptr || listener == nullptr)
+        {
+            throw std::invalid_argument("JVMTI environment and listener cannot be null");
+        }
+
+        std::lock_guard lock(mutex);
+
+        install(jvmti);
+
+        slot *free_slot = nullptr;
+
+        for (auto &slot : slots)
+        {
+            if (slot.listener.load(std::memory_order_relaxed) == listener)
+            {
+                throw std::invalid_argument("Listener is already subscribed");
+            }
+
+            if (free_slot == nullptr && slot.listener.load(std::memory_order_relaxed) == nullptr)
+            {
+                free_slot = &slot;
+            }
+        }
+
+        if (free_slot == nullptr)
+        {
+            throw std::runtime_error("No free JVMTI listener slots");
+        }
+
+        uint64_t mask = 0;
+
+        for (const auto event : events)
+        {
+            try
+            {
+                set_event(jvmti, event, true);
+            }
+            catch (...)
+            {
+                for (const auto enabled : events)
+                {
+                    if ((mask & uint64_t{1} << (enabled - JVMTI_MIN_EVENT_TYPE_VAL)) != 0)
+                    {
+                        set_event(jvmti, enabled, false);
+                    }
+                }
+
+                throw;
+            }
+
+            mask |= uint64_t{1} << (event - JVMTI_MIN_EVENT_TYPE_VAL);
+        }
+
+        free_slot->events.store(mask, std::memory_order_relaxed);
+        free_slot->listener.store(listener, std::memory_order_release);
+    }
+
+    void jvmti_callbacks::unsubscribe(jvmtiEnv *jvmti, const jvmti_listener *listener)
+    {
+        std::lock_guard lock(mutex);
+
+        for (auto &slot : slots)
+        {
+            if (slot.listener.load(std::memory_order_relaxed) != listener)
+            {
+                continue;
+            }
+
+            slot.listener.store(nullptr, std::memory_order_seq_cst);
+
+            while (slot.active.load(std::memory_order_seq_cst) != 0)
+            {
+                std::this_thread::yield();
+            }
+
+            const uint64_t mask = slot.events.exchange(0, std::memory_order_relaxed);
+
+            for (size_t i = 0; i < event_count; ++i)
+            {
+                if ((mask & uint64_t{1} << i) == 0)
+                {
+                    continue;
+                }
+
+                try
+                {
+                    set_event(jvmti, static_cast<jvmtiEvent>(JVMTI_MIN_EVENT_TYPE_VAL + i), false);
+                }
+                catch (const std::exception &e)
+                {
+                    debug_print_cerr(std::string("[JVMTI] ") + e.what());
+                }
+            }
+
+            return;
+        }
+    }
+}
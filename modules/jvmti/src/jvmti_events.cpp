@@ -0,0 +1,312 @@
+#include "ZNBKit/jvmti/jvmti_events.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "ZNBKit/debug.hpp"
+
+namespace
+{
+    std::atomic<uint64_t> next_thread_id{1};
+    thread_local uint64_t current_thread_id = 0;
+
+    uint64_t get_thread_id()
+    {
+        if (current_thread_id == 0)
+        {
+            current_thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return current_thread_id;
+    }
+
+    void copy_name(char *destination, const char *source)
+    {
+        std::strncpy(destination, source, znb_kit::jvmti_event::max_name_length - 1);
+        destination[znb_kit::jvmti_event::max_name_length - 1] = '\0';
+    }
+
+    znb_kit::jvmti_event make_event(const znb_kit::jvmti_event::event_type type)
+    {
+        znb_kit::jvmti_event event;
+        event.type = type;
+        event.method = nullptr;
+        event.address = nullptr;
+        event.size = 0;
+        event.name[0] = '\0';
+
+        return event;
+    }
+}
+
+namespace znb_kit
+{
+    jvmti_events::jvmti_events(jvmtiEnv *jvmti): jvmti(jvmti)
+    {
+    }
+
+    jvmti_events::~jvmti_events()
+    {
+        stop();
+    }
+
+    void jvmti_events::start(const options &options)
+    {
+        if (running.exchange(true))
+        {
+            return;
+        }
+
+        resolve_class_names = options.resolve_class_names;
+        dispatcher = std::thread(&jvmti_events::dispatch, this);
+
+        std::vector<jvmtiEvent> events;
+
+        const auto add = [&](const jvmti_event::event_type type, const jvmtiEvent event) {
+            if (options.events & jvmti_event::mask(type))
+            {
+                events.push_back(event);
+            }
+        };
+
+        add(jvmti_event::CLASS_LOAD, JVMTI_EVENT_CLASS_LOAD);
+        add(jvmti_event::CLASS_PREPARE, JVMTI_EVENT_CLASS_PREPARE);
+        add(jvmti_event::THREAD_START, JVMTI_EVENT_THREAD_START);
+        add(jvmti_event::GARBAGE_COLLECTION_START, JVMTI_EVENT_GARBAGE_COLLECTION_START);
+        add(jvmti_event::GARBAGE_COLLECTION_FINISH, JVMTI_EVENT_GARBAGE_COLLECTION_FINISH);
+        add(jvmti_event::COMPILED_METHOD_LOAD, JVMTI_EVENT_COMPILED_METHOD_LOAD);
+        add(jvmti_event::COMPILED_METHOD_UNLOAD, JVMTI_EVENT_COMPILED_METHOD_UNLOAD);
+        add(jvmti_event::DYNAMIC_CODE_GENERATED, JVMTI_EVENT_DYNAMIC_CODE_GENERATED);
+
+        /*
+         * ThreadEnd is always needed to hand the ring of a finished thread back to the pool.
+         */
+        events.push_back(JVMTI_EVENT_THREAD_END);
+
+        enabled_events = options.events;
+
+        try
+        {
+            jvmti_callbacks::subscribe(jvmti, this, events);
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    void jvmti_events::stop()
+    {
+        if (!running.load())
+        {
+            return;
+        }
+
+        jvmti_callbacks::unsubscribe(jvmti, this);
+
+        running.store(false);
+        pending.store(true);
+        pending.notify_one();
+
+        if (dispatcher.joinable())
+        {
+            dispatcher.join();
+        }
+    }
+
+    size_t jvmti_events::subscribe(subscriber callback, const uint32_t events)
+    {
+        if (!callback)
+        {
+            throw std::invalid_argument("Event subscriber cannot be empty");
+        }
+
+        std::lock_guard lock(subscriptions_mutex);
+
+        auto updated = std::make_shared<std::vector<subscription>>(*subscriptions.load());
+
+        const size_t id = next_subscription++;
+        updated->push_back({id, events, std::move(callback)});
+
+        subscriptions.store(std::move(updated));
+
+        return id;
+    }
+
+    void jvmti_events::unsubscribe(const size_t id)
+    {
+        std::lock_guard lock(subscriptions_mutex);
+
+        auto updated = std::make_shared<std::vector<subscription>>(*subscriptions.load());
+
+        std::erase_if(*updated, [id](const subscription &subscription) {
+            return subscription.id == id;
+        });
+
+        subscriptions.store(std::move(updated));
+    }
+
+    void jvmti_events::publish(jvmti_event &event)
+    {
+        event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        event.thread = get_thread_id();
+
+        if (!rings.push(event))
+        {
+            return;
+        }
+
+        /*
+         * Only the first event after the dispatcher went idle pays for the wake-up.
+         */
+        if (!pending.exchange(true, std::memory_order_acq_rel))
+        {
+            pending.notify_one();
+        }
+    }
+
+    void jvmti_events::publish_class(const jvmti_event::event_type type, const jclass klass)
+    {
+        auto event = make_event(type);
+
+        if (resolve_class_names)
+        {
+            char *signature = nullptr;
+
+            if (jvmti->GetClassSignature(klass, &signature, nullptr) == JVMTI_ERROR_NONE && signature != nullptr)
+            {
+                copy_name(event.name, signature);
+                jvmti->Deallocate(reinterpret_cast<unsigned char *>(signature));
+            }
+        }
+
+        publish(event);
+    }
+
+    void jvmti_events::dispatch()
+    {
+        std::vector<jvmti_event> batch;
+        batch.reserve(1024);
+
+        while (true)
+        {
+            pending.store(false, std::memory_order_release);
+
+            rings.drain([&batch](const jvmti_event &event) {
+                batch.push_back(event);
+            });
+
+            if (!batch.empty())
+            {
+                const auto current = subscriptions.load();
+
+                for (const auto &event : batch)
+                {
+                    for (const auto &subscription : *current)
+                    {
+                        if ((subscription.events & jvmti_event::mask(event.type)) == 0)
+                        {
+                            continue;
+                        }
+
+                        try
+                        {
+                            subscription.callback(event);
+                        }
+                        catch (const std::exception &e)
+                        {
+                            debug_print_cerr(std::string("jvmti_events subscriber threw: ") + e.what());
+                        }
+                    }
+                }
+
+                delivered.fetch_add(batch.size(), std::memory_order_relaxed);
+                batch.clear();
+
+                continue;
+            }
+
+            if (!running.load())
+            {
+                break;
+            }
+
+            pending.wait(false, std::memory_order_acquire);
+        }
+    }
+
+    void jvmti_events::on_thread_start(jvmtiEnv *, JNIEnv *, jthread)
+    {
+        auto event = make_event(jvmti_event::THREAD_START);
+        publish(event);
+    }
+
+    void jvmti_events::on_thread_end(jvmtiEnv *, JNIEnv *, jthread)
+    {
+        if (enabled_events & jvmti_event::mask(jvmti_event::THREAD_END))
+        {
+            auto event = make_event(jvmti_event::THREAD_END);
+            publish(event);
+        }
+
+        rings.release_current();
+    }
+
+    void jvmti_events::on_class_load(jvmtiEnv *, JNIEnv *, jthread, const jclass klass)
+    {
+        publish_class(jvmti_event::CLASS_LOAD, klass);
+    }
+
+    void jvmti_events::on_class_prepare(jvmtiEnv *, JNIEnv *, jthread, const jclass klass)
+    {
+        publish_class(jvmti_event::CLASS_PREPARE, klass);
+    }
+
+    void jvmti_events::on_compiled_method_load(jvmtiEnv *, const jmethodID method, const jint code_size, const void *code_addr, jint,
+                                               const jvmtiAddrLocationMap *, const void *)
+    {
+        auto event = make_event(jvmti_event::COMPILED_METHOD_LOAD);
+        event.method = method;
+        event.address = code_addr;
+        event.size = code_size;
+
+        publish(event);
+    }
+
+    void jvmti_events::on_compiled_method_unload(jvmtiEnv *, const jmethodID method, const void *code_addr)
+    {
+        auto event = make_event(jvmti_event::COMPILED_METHOD_UNLOAD);
+        event.method = method;
+        event.address = code_addr;
+
+        publish(event);
+    }
+
+    void jvmti_events::on_dynamic_code_generated(jvmtiEnv *, const char *name, const void *address, const jint length)
+    {
+        auto event = make_event(jvmti_event::DYNAMIC_CODE_GENERATED);
+        event.address = address;
+        event.size = length;
+
+        if (name != nullptr)
+        {
+            copy_name(event.name, name);
+        }
+
+        publish(event);
+    }
+
+    void jvmti_events::on_garbage_collection_start(jvmtiEnv *)
+    {
+        auto event = make_event(jvmti_event::GARBAGE_COLLECTION_START);
+        publish(event);
+    }
+
+    void jvmti_events::on_garbage_collection_finish(jvmtiEnv *)
+    {
+        auto event = make_event(jvmti_event::GARBAGE_COLLECTION_FINISH);
+        publish(event);
+    }
+}
@@ -12,6 +12,7 @@
 #include "ZNBKit/jni/signatures/method/object_method.hpp"
 #include "ZNBKit/jni/signatures/method/short_method.hpp"
 #include "ZNBKit/jni/signatures/method/void_method.hpp"
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
 
 /*
  * For now include all JNI types here. It probably isn't good idea to include all of them until they're all implemented but who cares.
@@ -31,25 +32,6 @@
     TYPE(jchar) \
     TYPE(jshort)
 
-namespace
-{
-    template<typename JVMTI_ALLOC_TYPE>
-    struct jvmti_deleter
-    {
-        jvmtiEnv *jvmti_env;
-
-        void operator()(JVMTI_ALLOC_TYPE *ptr) const
-        {
-            if (jvmti_env && ptr)
-            {
-                jvmti_env->Deallocate(reinterpret_cast<unsigned char *>(ptr));
-            }
-        }
-    };
-
-    template<typename JVMTI_ALLOC_TYPE>
-    using jvmti_ptr = std::unique_ptr<JVMTI_ALLOC_TYPE, jvmti_deleter<JVMTI_ALLOC_TYPE>>;
-}
 namespace znb_kit
 {
 #define INSTANTIATE_GET_METHOD_SIGNATURE_OBJECT(TYPE) \
@@ -74,7 +56,7 @@ namespace znb_kit
         const std::optional<std::vector<std::string>> &params, \
         bool is_static) \
     { \
-        return std::make_unique<SUFFIX##_method>(jni, klass_signature(owner_ks), name, signature, params, is_static); \
+        return std::make_unique<SUFFIX##_method>(jni, owner_ks, name, signature, params, is_static); \
     }
 
 #define MAPPINGS(APPLY) \
@@ -116,11 +98,7 @@ namespace znb_kit
 
         if (error != JVMTI_ERROR_NONE)
         {
-            char *raw_error_buffer = nullptr;
-            jvmti->GetErrorName(error, &raw_error_buffer);
-            jvmti_ptr<char> error_buffer(raw_error_buffer, {jvmti});
-            
-            debug_print("factory::get_method_signature() JVMTI GetMethodName error: " + (error_buffer ? std::string(error_buffer.get()) : "Unknown error"));
+            debug_print("factory::get_method_signature() JVMTI GetMethodName error: " + get_error_name(jvmti, error));
 
             return nullptr;
         }
@@ -143,7 +121,6 @@ namespace znb_kit
 
         const bool is_static = (modifiers & ACC_STATIC) != 0;
         auto params = get_parameters(jni, method);
-        auto ptr = std::make_shared<klass_signature>(owner_ks);
 
         return create_method_instance<T>(jni, owner_ks, name, signature, params, is_static);
     }
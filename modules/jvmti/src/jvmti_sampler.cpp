@@ -0,0 +1,245 @@
+#include "ZNBKit/jvmti/jvmti_sampler.hpp"
+
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+namespace znb_kit
+{
+    size_t jvmti_sampler::stack_hash::operator()(const std::vector<jmethodID> &stack) const noexcept
+    {
+        size_t hash = stack.size();
+
+        for (const auto method : stack)
+        {
+            hash ^= reinterpret_cast<uintptr_t>(method) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+
+        return hash;
+    }
+
+    jvmti_sampler::jvmti_sampler(JavaVM *vm, jvmtiEnv *jvmti): vm(vm), jvmti(jvmti), symbolizer(jvmti)
+    {
+        if (vm == nullptr)
+        {
+            throw std::invalid_argument("JavaVM cannot be null");
+        }
+    }
+
+    jvmti_sampler::~jvmti_sampler()
+    {
+        stop();
+    }
+
+    void jvmti_sampler::start(const options &options)
+    {
+        if (running.exchange(true))
+        {
+            return;
+        }
+
+        if (options.interval.count() <= 0 || options.max_frames <= 0)
+        {
+            running = false;
+            throw std::invalid_argument("Sampler interval and frame depth have to be positive");
+        }
+
+        /*
+         * A previous run that failed to attach clears the flag by itself but is still joinable.
+         */
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+
+        started_at = std::chrono::steady_clock::now();
+        sampling_time = 0;
+
+        thread = std::thread(&jvmti_sampler::run, this, options);
+    }
+
+    void jvmti_sampler::stop()
+    {
+        {
+            std::lock_guard lock(wake_mutex);
+            running = false;
+        }
+
+        wake.notify_all();
+
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+    void jvmti_sampler::run(const options options)
+    {
+        JNIEnv *jni = nullptr;
+
+        JavaVMAttachArgs attach_args;
+        attach_args.version = JNI_VERSION_1_8;
+        attach_args.name = const_cast<char *>("znb-sampler");
+        attach_args.group = nullptr;
+
+        if (vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void **>(&jni), &attach_args) != JNI_OK)
+        {
+            debug_print_cerr("[SAMPLER] Unable to attach sampler thread");
+            running = false;
+            return;
+        }
+
+        auto next = std::chrono::steady_clock::now();
+
+        std::vector<jmethodID> stack;
+        stack.reserve(options.max_frames);
+
+        while (running.load())
+        {
+            next += options.interval;
+
+            {
+                std::unique_lock lock(wake_mutex);
+
+                if (wake.wait_until(lock, next, [this] { return !running.load(); }))
+                {
+                    break;
+                }
+            }
+
+            const auto tick = std::chrono::steady_clock::now();
+
+            jvmtiStackInfo *raw_infos = nullptr;
+            jint thread_count = 0;
+
+            jni->PushLocalFrame(16);
+
+            if (const auto error = jvmti->GetAllStackTraces(options.max_frames, &raw_infos, &thread_count); error != JVMTI_ERROR_NONE)
+            {
+                jni->PopLocalFrame(nullptr);
+
+                debug_print_cerr("[SAMPLER] GetAllStackTraces failed: " + get_error_name(jvmti, error));
+                continue;
+            }
+
+            const jvmti_ptr<jvmtiStackInfo> infos(raw_infos, {jvmti});
+
+            {
+                std::lock_guard lock(stacks_mutex);
+
+                for (jint i = 0; i < thread_count; ++i)
+                {
+                    const auto &info = infos.get()[i];
+
+                    if (info.frame_count == 0 || (options.runnable_only && (info.state & JVMTI_THREAD_STATE_RUNNABLE) == 0))
+                    {
+                        continue;
+                    }
+
+                    stack.clear();
+
+                    for (jint frame = info.frame_count - 1; frame >= 0; --frame)
+                    {
+                        stack.push_back(info.frame_buffer[frame].method);
+                    }
+
+                    ++stacks[stack];
+                    ++samples;
+                }
+            }
+
+            jni->PopLocalFrame(nullptr);
+
+            sampling_time += (std::chrono::steady_clock::now() - tick).count();
+
+            /*
+             * A long pause (debugger, suspended process) should not turn into a burst of catch-up samples.
+             */
+            if (const auto now = std::chrono::steady_clock::now(); next < now)
+            {
+                next = now;
+            }
+        }
+
+        vm->DetachCurrentThread();
+    }
+
+    void jvmti_sampler::reset()
+    {
+        std::lock_guard lock(stacks_mutex);
+
+        stacks.clear();
+        samples = 0;
+    }
+
+    std::map<std::string, size_t> jvmti_sampler::snapshot()
+    {
+        std::vector<std::pair<std::vector<jmethodID>, size_t>> copy;
+        {
+            std::lock_guard lock(stacks_mutex);
+            copy.assign(stacks.begin(), stacks.end());
+        }
+
+        JNIEnv *jni = nullptr;
+
+        if (vm->GetEnv(reinterpret_cast<void **>(&jni), JNI_VERSION_1_8) != JNI_OK)
+        {
+            jni = nullptr;
+        }
+
+        std::map<std::string, size_t> collapsed;
+
+        for (const auto &[stack, count] : copy)
+        {
+            std::string key;
+
+            for (const auto method : stack)
+            {
+                if (!key.empty())
+                {
+                    key += ';';
+                }
+
+                key += symbolizer.resolve(method, jni);
+            }
+
+            collapsed[key] += count;
+        }
+
+        return collapsed;
+    }
+
+    std::string jvmti_sampler::dump()
+    {
+        std::string result;
+
+        for (const auto &[stack, count] : snapshot())
+        {
+            result += std::format("{} {}\n", stack, count);
+        }
+
+        return result;
+    }
+
+    void jvmti_sampler::dump(const std::filesystem::path &path)
+    {
+        std::ofstream out(path, std::ios::trunc);
+
+        if (!out)
+        {
+            throw std::runtime_error("Unable to write profile: " + path.string());
+        }
+
+        out << dump();
+    }
+
+    double jvmti_sampler::get_overhead() const
+    {
+        const auto elapsed = (std::chrono::steady_clock::now() - started_at).count();
+
+        return elapsed > 0 ? static_cast<double>(sampling_time.load()) / static_cast<double>(elapsed) : 0.0;
+    }
+}
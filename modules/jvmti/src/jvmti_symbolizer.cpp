@@ -0,0 +1,129 @@
+#include "ZNBKit/jvmti/jvmti_symbolizer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+namespace znb_kit
+{
+    jvmti_symbolizer::jvmti_symbolizer(jvmtiEnv *jvmti): jvmti(jvmti)
+    {
+        if (jvmti == nullptr)
+        {
+            throw std::invalid_argument("JVMTI environment cannot be null");
+        }
+    }
+
+    std::string jvmti_symbolizer::resolve(const jmethodID method, JNIEnv *jni)
+    {
+        {
+            std::lock_guard lock(mutex);
+
+            if (const auto it = methods.find(method); it != methods.end())
+            {
+                return it->second;
+            }
+        }
+
+        char *raw_name = nullptr;
+
+        if (jvmti->GetMethodName(method, &raw_name, nullptr, nullptr) != JVMTI_ERROR_NONE)
+        {
+            return "[unknown]";
+        }
+
+        const jvmti_ptr<char> name(raw_name, {jvmti});
+
+        std::string klass_name = "[unknown]";
+        jclass klass = nullptr;
+
+        if (jvmti->GetMethodDeclaringClass(method, &klass) == JVMTI_ERROR_NONE && klass != nullptr)
+        {
+            klass_name = resolve_class(klass);
+
+            if (jni != nullptr)
+            {
+                jni->DeleteLocalRef(klass);
+            }
+        }
+
+        std::string symbol = klass_name + "." + name.get();
+
+        std::lock_guard lock(mutex);
+        methods.emplace(method, symbol);
+
+        return symbol;
+    }
+
+    std::string jvmti_symbolizer::resolve_class(const jclass klass) const
+    {
+        char *raw_signature = nullptr;
+
+        if (jvmti->GetClassSignature(klass, &raw_signature, nullptr) != JVMTI_ERROR_NONE)
+        {
+            return "[unknown]";
+        }
+
+        const jvmti_ptr<char> signature(raw_signature, {jvmti});
+
+        return to_class_name(signature.get());
+    }
+
+    std::string jvmti_symbolizer::to_class_name(std::string_view signature)
+    {
+        size_t dimensions = 0;
+
+        while (signature.starts_with('['))
+        {
+            signature.remove_prefix(1);
+            ++dimensions;
+        }
+
+        std::string name;
+
+        if (signature.starts_with('L') && signature.ends_with(';'))
+        {
+            name = signature.substr(1, signature.size() - 2);
+            std::ranges::replace(name, '/', '.');
+        }
+        else if (signature.size() == 1)
+        {
+            switch (signature.front())
+            {
+            case 'Z': name = "boolean"; break;
+            case 'B': name = "byte"; break;
+            case 'C': name = "char"; break;
+            case 'S': name = "short"; break;
+            case 'I': name = "int"; break;
+            case 'J': name = "long"; break;
+            case 'F': name = "float"; break;
+            case 'D': name = "double"; break;
+            default: name = signature; break;
+            }
+        }
+        else
+        {
+            name = signature;
+        }
+
+        for (size_t i = 0; i < dimensions; ++i)
+        {
+            name += "[]";
+        }
+
+        return name;
+    }
+
+    size_t jvmti_symbolizer::size() const
+    {
+        std::lock_guard lock(mutex);
+        return methods.size();
+    }
+
+    void jvmti_symbolizer::clear()
+    {
+        std::lock_guard lock(mutex);
+        methods.clear();
+    }
+}
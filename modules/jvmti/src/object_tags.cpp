@@ -0,0 +1,234 @@
+#include "ZNBKit/jvmti/object_tags.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+#include "ZNBKit/internal/wrapper.hpp"
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+namespace znb_kit
+{
+    object_tags::object_tags(jvmtiEnv *jvmti): jvmti(jvmti)
+    {
+    }
+
+    object_tags::~object_tags()
+    {
+        stop();
+
+        for (auto *node = overflow.exchange(nullptr); node != nullptr;)
+        {
+            delete std::exchange(node, node->next);
+        }
+    }
+
+    void object_tags::start(const options &options)
+    {
+        if (running)
+        {
+            return;
+        }
+
+        if (options.batch == 0 || (options.on_freed && options.interval.count() <= 0))
+        {
+            throw std::invalid_argument("Batch size and drain interval have to be positive");
+        }
+
+        jvmti_callbacks::subscribe(jvmti, this, {JVMTI_EVENT_OBJECT_FREE});
+        running = true;
+
+        if (options.on_freed)
+        {
+            working = true;
+            worker = std::thread(&object_tags::run, this, options);
+        }
+    }
+
+    void object_tags::stop()
+    {
+        if (!running)
+        {
+            return;
+        }
+
+        jvmti_callbacks::unsubscribe(jvmti, this);
+        running = false;
+
+        {
+            std::lock_guard lock(wake_mutex);
+            working = false;
+        }
+
+        wake.notify_all();
+
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+    void object_tags::run(const options options)
+    {
+        while (true)
+        {
+            {
+                std::unique_lock lock(wake_mutex);
+                wake.wait_for(lock, options.interval, [this] { return !working.load(); });
+            }
+
+            drain_freed(options.on_freed, options.batch);
+
+            if (!working.load())
+            {
+                break;
+            }
+        }
+    }
+
+    void object_tags::associate(const jobject object, const jlong handle)
+    {
+        VAR_CHECK(object);
+
+        if (handle == 0)
+        {
+            throw std::invalid_argument("Native handle cannot be zero");
+        }
+
+        if (const auto error = jvmti->SetTag(object, handle); error != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to tag object: " + get_error_name(jvmti, error));
+        }
+    }
+
+    void object_tags::dissociate(const jobject object)
+    {
+        VAR_CHECK(object);
+
+        if (const auto error = jvmti->SetTag(object, 0); error != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to untag object: " + get_error_name(jvmti, error));
+        }
+    }
+
+    std::optional<jlong> object_tags::get(const jobject object) const
+    {
+        VAR_CHECK(object);
+
+        jlong tag = 0;
+
+        if (const auto error = jvmti->GetTag(object, &tag); error != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to get object tag: " + get_error_name(jvmti, error));
+        }
+
+        if (tag == 0)
+        {
+            return std::nullopt;
+        }
+
+        return tag;
+    }
+
+    std::vector<std::pair<jobject, jlong>> object_tags::find(const std::span<const jlong> handles) const
+    {
+        if (handles.empty())
+        {
+            return {};
+        }
+
+        jint count = 0;
+        jobject *raw_objects = nullptr;
+        jlong *raw_tags = nullptr;
+
+        if (const auto error = jvmti->GetObjectsWithTags(static_cast<jint>(handles.size()), handles.data(), &count, &raw_objects, &raw_tags);
+            error != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to get objects with tags: " + get_error_name(jvmti, error));
+        }
+
+        const jvmti_ptr<jobject> objects(raw_objects, {jvmti});
+        const jvmti_ptr<jlong> tags(raw_tags, {jvmti});
+
+        std::vector<std::pair<jobject, jlong>> result;
+        result.reserve(count);
+
+        for (jint i = 0; i < count; ++i)
+        {
+            result.emplace_back(objects.get()[i], tags.get()[i]);
+        }
+
+        return result;
+    }
+
+    size_t object_tags::drain_freed(const free_handler &handler, const size_t batch)
+    {
+        VAR_CHECK(handler);
+
+        if (batch == 0)
+        {
+            throw std::invalid_argument("Batch size has to be positive");
+        }
+
+        /*
+         * thread_rings allows a single consumer only.
+         */
+        std::lock_guard lock(drain_mutex);
+
+        std::vector<jlong> handles;
+        handles.reserve(batch);
+
+        size_t delivered = 0;
+
+        const auto collect = [&](const jlong handle) {
+            handles.push_back(handle);
+
+            if (handles.size() == batch)
+            {
+                handler(handles);
+                delivered += handles.size();
+                handles.clear();
+            }
+        };
+
+        std::vector<jlong> spilled;
+
+        for (auto *node = overflow.exchange(nullptr, std::memory_order_acquire); node != nullptr;)
+        {
+            const std::unique_ptr<overflow_node> current(std::exchange(node, node->next));
+            spilled.push_back(current->handle);
+        }
+
+        freed.drain(collect);
+        std::ranges::for_each(spilled, collect);
+
+        if (!handles.empty())
+        {
+            handler(handles);
+            delivered += handles.size();
+        }
+
+        return delivered;
+    }
+
+    void object_tags::on_object_free(jvmtiEnv *, const jlong tag)
+    {
+        if (freed.push(tag))
+        {
+            return;
+        }
+
+        auto *node = new (std::nothrow) overflow_node{tag, overflow.load(std::memory_order_relaxed)};
+
+        if (node == nullptr)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        while (!overflow.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+}
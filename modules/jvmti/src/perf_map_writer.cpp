@@ -0,0 +1,129 @@
+#include "ZNBKit/jvmti/perf_map_writer.hpp"
+
+#include <format>
+#include <stdexcept>
+#include <unistd.h>
+#include <vector>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/thread_env.hpp"
+#include "ZNBKit/jvmti/jvmti_ptr.hpp"
+
+namespace znb_kit
+{
+    perf_map_writer::perf_map_writer(jvmtiEnv *jvmti): jvmti(jvmti), symbolizer(jvmti)
+    {
+    }
+
+    perf_map_writer::~perf_map_writer()
+    {
+        stop();
+    }
+
+    void perf_map_writer::start(const options &options)
+    {
+        if (running)
+        {
+            return;
+        }
+
+        path = options.path.value_or(std::filesystem::path(std::format("/tmp/perf-{}.map", getpid())));
+
+        {
+            std::lock_guard lock(stream_mutex);
+
+            stream.open(path, std::ios::out | std::ios::trunc);
+
+            if (!stream)
+            {
+                throw std::runtime_error("Failed to open perf map: " + path.string());
+            }
+        }
+
+        std::vector events = {JVMTI_EVENT_COMPILED_METHOD_LOAD, JVMTI_EVENT_COMPILED_METHOD_UNLOAD};
+
+        if (options.include_stubs)
+        {
+            events.push_back(JVMTI_EVENT_DYNAMIC_CODE_GENERATED);
+        }
+
+        jvmti_callbacks::subscribe(jvmti, this, events);
+        running = true;
+
+        for (const auto event : events)
+        {
+            if (event == JVMTI_EVENT_COMPILED_METHOD_UNLOAD)
+            {
+                continue;
+            }
+
+            if (const auto error = jvmti->GenerateEvents(event); error != JVMTI_ERROR_NONE)
+            {
+                debug_print_cerr("[PERF] GenerateEvents failed: " + get_error_name(jvmti, error));
+            }
+        }
+    }
+
+    void perf_map_writer::stop()
+    {
+        if (!running)
+        {
+            return;
+        }
+
+        jvmti_callbacks::unsubscribe(jvmti, this);
+        running = false;
+
+        std::lock_guard lock(stream_mutex);
+        stream.close();
+    }
+
+    void perf_map_writer::write(const void *address, const jint size, const std::string &name)
+    {
+        if (address == nullptr || size <= 0)
+        {
+            return;
+        }
+
+        const auto line = std::format("{:x} {:x} {}\n", reinterpret_cast<uintptr_t>(address), size, name);
+
+        std::lock_guard lock(stream_mutex);
+
+        if (!stream.is_open())
+        {
+            return;
+        }
+
+        stream << line;
+        stream.flush();
+
+        entries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void perf_map_writer::on_compiled_method_load(jvmtiEnv *, const jmethodID method, const jint code_size, const void *code_addr, jint,
+                                                  const jvmtiAddrLocationMap *, const void *)
+    {
+        /*
+         * Compiled-method events arrive on VM threads that are already attached, so only look the env up; with it the
+         * symbolizer drops the declaring class reference instead of leaving it to pile up on the callback thread.
+         */
+        JNIEnv *jni = nullptr;
+
+        if (const auto vm = thread_env::get_vm(); vm == nullptr || vm->GetEnv(reinterpret_cast<void **>(&jni), JNI_VERSION_1_8) != JNI_OK)
+        {
+            jni = nullptr;
+        }
+
+        write(code_addr, code_size, symbolizer.resolve(method, jni));
+    }
+
+    void perf_map_writer::on_compiled_method_unload(jvmtiEnv *, jmethodID, const void *)
+    {
+        unloaded.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void perf_map_writer::on_dynamic_code_generated(jvmtiEnv *, const char *name, const void *address, const jint length)
+    {
+        write(address, length, name != nullptr ? name : "[stub]");
+    }
+}
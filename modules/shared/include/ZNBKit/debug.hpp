@@ -4,42 +4,26 @@
 
 #pragma once
 
-#include <iostream>
+#include <string_view>
 
-inline std::string get_path(const std::string& filePath) {
-    const std::string sep = "/cpp/";
+#include "ZNBKit/internal/logger.hpp"
 
-    if (const size_t pos = filePath.find(sep); pos != std::string::npos) {
-        return filePath.substr(pos + sep.length());
+constexpr std::string_view get_path(const std::string_view file_path) {
+    constexpr std::string_view sep = "/cpp/";
+
+    if (const size_t pos = file_path.find(sep); pos != std::string_view::npos) {
+        return file_path.substr(pos + sep.length());
     }
 
-    return "";
+    return {};
 }
 
-template<typename T>
- const char* to_c_str(const T& msg) {
-    if constexpr (std::is_same_v<T, std::string>) {
-        return msg.c_str();
-    } else {
-        return msg;
-    }
-}
+/*
+ * Kept for existing call sites, now routed through znb_kit::logger: nothing is formatted unless the level is
+ * enabled, and levels below ZNB_LOG_LEVEL are compiled out.
+ */
+#define debug_print(msg) ZNB_LOG_MESSAGE(znb_kit::LEVEL_DEBUG, msg)
+
+#define debug_print_ignore_formatting(msg) ZNB_LOG_MESSAGE(znb_kit::LEVEL_INFO, msg)
 
-#ifdef DEBUG
-#define debug_print(msg) \
-printf("[DEBUG] %s:%d %s\n", get_path(__FILE__).c_str(), __LINE__, to_c_str(msg))
-#else
-#define debug_print(msg) \
-printf("[DEBUG] %s\n", to_c_str(msg))
-#endif
-
-#define debug_print_ignore_formatting(msg) \
-printf("[DEBUG] %s\n", to_c_str(msg))
-
-#ifdef SHOULD_DISPLAY
-#define debug_print_cerr(msg) \
-fprintf(stderr, "[DEBUG] %s:%d %s\n", __FILE_NAME__, __LINE__, to_c_str(msg))
-#else
-#define debug_print_cerr(msg) \
-printf("[DEBUG] %s\n", to_c_str(msg))
-#endif
+#define debug_print_cerr(msg) ZNB_LOG_MESSAGE(znb_kit::LEVEL_WARN, msg)
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace znb_kit
+{
+    /*
+     * Log-linear histogram in the spirit of HdrHistogram: every power of two is split into 2^SubBits linear buckets,
+     * so the relative error of a recorded value stays below 2^-SubBits across the whole range. Recording is a couple
+     * of relaxed atomic increments and can happen from any thread, including JVMTI callbacks that must not lock.
+     */
+    template <size_t SubBits = 4>
+    class log_histogram
+    {
+        static constexpr size_t sub_buckets = size_t{1} << SubBits;
+        static constexpr size_t bucket_count = (64 - SubBits + 1) * sub_buckets;
+
+        std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+
+        static size_t index_of(const uint64_t value)
+        {
+            if (value < sub_buckets)
+            {
+                return value;
+            }
+
+            const size_t exponent = std::bit_width(value) - SubBits - 1;
+            const size_t mantissa = (value >> exponent) & (sub_buckets - 1);
+
+            return (exponent + 1) * sub_buckets + mantissa;
+        }
+
+        /*
+         * Upper bound of the values that land in the bucket, which is what percentiles report.
+         */
+        static uint64_t value_of(const size_t index)
+        {
+            if (index < sub_buckets)
+            {
+                return index;
+            }
+
+            const size_t exponent = index / sub_buckets - 1;
+            const uint64_t mantissa = index % sub_buckets;
+
+            return ((sub_buckets | mantissa) << exponent) + ((uint64_t{1} << exponent) - 1);
+        }
+
+    public:
+        struct snapshot
+        {
+            std::array<uint64_t, bucket_count> buckets{};
+
+            uint64_t count = 0;
+            uint64_t sum = 0;
+            uint64_t max = 0;
+
+            /*
+             * Smallest bucket bound with at least `percentile` percent of the values at or below it.
+             */
+            [[nodiscard]] uint64_t percentile(const double percentile) const
+            {
+                if (count == 0)
+                {
+                    return 0;
+                }
+
+                const auto target = static_cast<uint64_t>(static_cast<double>(count) * percentile / 100.0 + 0.5);
+                uint64_t seen = 0;
+
+                for (size_t i = 0; i < bucket_count; ++i)
+                {
+                    seen += buckets[i];
+
+                    if (seen >= target && seen > 0)
+                    {
+                        return value_of(i) < max ? value_of(i) : max;
+                    }
+                }
+
+                return max;
+            }
+
+            [[nodiscard]] double mean() const
+            {
+                return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+            }
+        };
+
+        void record(const uint64_t value)
+        {
+            buckets[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+
+            count.fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint64_t current = max.load(std::memory_order_relaxed);
+
+            while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /*
+         * Values recorded concurrently with a resetting read end up in either this snapshot or the next one, never both.
+         */
+        snapshot read(const bool reset)
+        {
+            snapshot result;
+
+            for (size_t i = 0; i < bucket_count; ++i)
+            {
+                result.buckets[i] = reset ? buckets[i].exchange(0, std::memory_order_relaxed) : buckets[i].load(std::memory_order_relaxed);
+            }
+
+            result.count = reset ? count.exchange(0, std::memory_order_relaxed) : count.load(std::memory_order_relaxed);
+            result.sum = reset ? sum.exchange(0, std::memory_order_relaxed) : sum.load(std::memory_order_relaxed);
+            result.max = reset ? max.exchange(0, std::memory_order_relaxed) : max.load(std::memory_order_relaxed);
+
+            return result;
+        }
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <jni.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+namespace znb_kit
+{
+    /*
+     * A Java exception taken out of the env, for the non-throwing call path. It holds a global ref to the throwable;
+     * class name and message are only decoded through JNI the first time they are read. Printing the stack trace is
+     * opt-in, either per call or process-wide through set_describe().
+     */
+    class java_error
+    {
+        struct state
+        {
+            jthrowable throwable = nullptr;
+
+            std::once_flag decoded;
+            std::string klass;
+            std::string message;
+
+            ~state();
+        };
+
+        std::shared_ptr<state> error;
+
+        static std::atomic_bool describe;
+
+        void decode(JNIEnv *jni) const;
+
+    public:
+        /*
+         * Clears the pending exception and takes it over. Only valid while an exception is pending.
+         */
+        static java_error take(JNIEnv *jni, bool describe_exception = false);
+
+        static void set_describe(const bool enabled)
+        {
+            describe.store(enabled, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] jthrowable get() const
+        {
+            return error->throwable;
+        }
+
+        /*
+         * Binary name, e.g. "java.lang.IllegalStateException". Without an env, the calling thread's env is used.
+         */
+        [[nodiscard]] const std::string &get_class_name(JNIEnv *jni = nullptr) const;
+
+        [[nodiscard]] const std::string &get_message(JNIEnv *jni = nullptr) const;
+
+        [[nodiscard]] bool is_instance_of(JNIEnv *jni, const jclass &klass) const;
+
+        /*
+         * Makes the exception pending again, e.g. to let it propagate out of a native method.
+         */
+        void rethrow(JNIEnv *jni) const;
+
+        void print(JNIEnv *jni) const;
+    };
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <jni.h>
+#include <utility>
+#include <vector>
+
+#include "ZNBKit/internal/wrapper.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Owning handle for a local reference returned by JNI. It takes over the reference as it is (no NewLocalRef),
+     * registers it with the local tracker and deletes it when it goes out of scope. Move-only.
+     */
+    template <typename T = jobject>
+    class local_ref
+    {
+        JNIEnv *jni = nullptr;
+        T ref = nullptr;
+
+    public:
+        local_ref() = default;
+
+        local_ref(JNIEnv *jni, T ref,
+                  const std::string &file = __builtin_FILE(), const int line = __builtin_LINE(),
+                  const std::string &method = __builtin_FUNCTION())
+            : jni(jni), ref(ref)
+        {
+            VAR_CHECK(jni);
+
+            wrapper::adopt_local_ref(jni, ref, file, line, method);
+        }
+
+        local_ref(const local_ref &) = delete;
+        local_ref &operator=(const local_ref &) = delete;
+
+        local_ref(local_ref &&other) noexcept
+            : jni(std::exchange(other.jni, nullptr)), ref(std::exchange(other.ref, nullptr))
+        {
+        }
+
+        local_ref &operator=(local_ref &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+
+                jni = std::exchange(other.jni, nullptr);
+                ref = std::exchange(other.ref, nullptr);
+            }
+
+            return *this;
+        }
+
+        ~local_ref()
+        {
+            reset();
+        }
+
+        [[nodiscard]] T get() const
+        {
+            return ref;
+        }
+
+        explicit operator bool() const
+        {
+            return ref != nullptr;
+        }
+
+        /*
+         * Gives up ownership; the caller becomes responsible for wrapper::remove_local_ref.
+         */
+        T release()
+        {
+            jni = nullptr;
+            return std::exchange(ref, nullptr);
+        }
+
+        void reset()
+        {
+            if (ref != nullptr && jni != nullptr)
+            {
+                wrapper::remove_local_ref(jni, ref);
+            }
+
+            jni = nullptr;
+            ref = nullptr;
+        }
+
+        template <typename U>
+        local_ref<U> cast() &&
+        {
+            local_ref<U> result;
+            result.jni = std::exchange(jni, nullptr);
+            result.ref = static_cast<U>(std::exchange(ref, nullptr));
+
+            return result;
+        }
+
+        template <typename>
+        friend class local_ref;
+    };
+
+    using local_object = local_ref<jobject>;
+    using local_string = local_ref<jstring>;
+    using local_class = local_ref<jclass>;
+
+    using local_object_array = local_ref<jobjectArray>;
+    using local_byte_array = local_ref<jbyteArray>;
+    using local_int_array = local_ref<jintArray>;
+    using local_long_array = local_ref<jlongArray>;
+
+    /*
+     * Object-returning call whose result is owned by the returned handle.
+     */
+    template <typename T = jobject>
+    local_ref<T> invoke_object(JNIEnv *jni, const jclass &klass, const jobject &instance,
+                               const jmethodID &method_id, const std::vector<jvalue> &parameters)
+    {
+        return local_ref<jobject>(jni, wrapper::invoke_object_method(jni, klass, instance, method_id, parameters)).template cast<T>();
+    }
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#include "ZNBKit/internal/spsc_ring.hpp"
+
+/*
+ * Lowest level compiled in; calls below it are discarded at compile time, arguments included. Set through the
+ * ZNB_LOG_LEVEL CMake cache variable.
+ */
+#define ZNB_LOG_LEVEL_DEBUG 0
+#define ZNB_LOG_LEVEL_INFO 1
+#define ZNB_LOG_LEVEL_WARN 2
+#define ZNB_LOG_LEVEL_ERROR 3
+#define ZNB_LOG_LEVEL_OFF 4
+
+#ifndef ZNB_LOG_LEVEL
+#define ZNB_LOG_LEVEL ZNB_LOG_LEVEL_DEBUG
+#endif
+
+/*
+ * The message expression is only evaluated once the level is known to be enabled.
+ */
+#define ZNB_LOG_MESSAGE(level, msg) \
+    do { \
+        if constexpr (static_cast<int>(level) >= ZNB_LOG_LEVEL) { \
+            if (znb_kit::logger::is_enabled(level)) { \
+                znb_kit::logger::write(level, __FILE__, __LINE__, msg); \
+            } \
+        } \
+    } while (false)
+
+#define ZNB_LOG(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(level) >= ZNB_LOG_LEVEL) { \
+            if (znb_kit::logger::is_enabled(level)) { \
+                znb_kit::logger::log(level, __FILE__, __LINE__, __VA_ARGS__); \
+            } \
+        } \
+    } while (false)
+
+#define ZNB_LOG_DEBUG(...) ZNB_LOG(znb_kit::LEVEL_DEBUG, __VA_ARGS__)
+#define ZNB_LOG_INFO(...) ZNB_LOG(znb_kit::LEVEL_INFO, __VA_ARGS__)
+#define ZNB_LOG_WARN(...) ZNB_LOG(znb_kit::LEVEL_WARN, __VA_ARGS__)
+#define ZNB_LOG_ERROR(...) ZNB_LOG(znb_kit::LEVEL_ERROR, __VA_ARGS__)
+
+namespace znb_kit
+{
+    enum log_level : uint8_t
+    {
+        LEVEL_DEBUG = ZNB_LOG_LEVEL_DEBUG,
+        LEVEL_INFO = ZNB_LOG_LEVEL_INFO,
+        LEVEL_WARN = ZNB_LOG_LEVEL_WARN,
+        LEVEL_ERROR = ZNB_LOG_LEVEL_ERROR,
+        LEVEL_OFF = ZNB_LOG_LEVEL_OFF,
+    };
+
+    std::string_view get_level_name(log_level level);
+
+    struct log_record
+    {
+        log_level level;
+        std::chrono::system_clock::time_point timestamp;
+
+        std::string_view file;
+        int line;
+
+        std::string_view message;
+    };
+
+    class log_sink
+    {
+    public:
+        virtual ~log_sink() = default;
+
+        /*
+         * Called from any thread; the record's views are only valid during the call.
+         */
+        virtual void write(const log_record &record) = 0;
+
+        virtual void flush()
+        {
+        }
+    };
+
+    /*
+     * One fprintf per record: debug and info to `out`, warnings and errors to `err`.
+     */
+    class stream_sink final : public log_sink
+    {
+        FILE *out;
+        FILE *err;
+
+        bool with_location;
+
+    public:
+        explicit stream_sink(FILE *out = stdout, FILE *err = stderr, bool with_location = false);
+
+        void write(const log_record &record) override;
+
+        void flush() override;
+    };
+
+    /*
+     * Moves writing off the calling thread: records are copied into per-thread rings and handed to the target sink
+     * by a single writer thread. Records are dropped rather than blocking when a ring is full, and messages longer
+     * than an entry are truncated.
+     */
+    class async_sink final : public log_sink
+    {
+    public:
+        static constexpr size_t MESSAGE_SIZE = 384;
+        static constexpr size_t FILE_SIZE = 96;
+
+        explicit async_sink(std::shared_ptr<log_sink> target);
+
+        async_sink(const async_sink &) = delete;
+        async_sink &operator=(const async_sink &) = delete;
+
+        /*
+         * Writes out whatever is still queued before returning.
+         */
+        ~async_sink() override;
+
+        void write(const log_record &record) override;
+
+        /*
+         * Blocks until everything queued before the call reached the target sink.
+         */
+        void flush() override;
+
+        /*
+         * Hands back the ring of the calling thread; done automatically when a thread that wrote here exits.
+         */
+        void release_current();
+
+        [[nodiscard]] size_t get_dropped() const
+        {
+            return rings.get_dropped();
+        }
+
+    private:
+        struct entry
+        {
+            log_level level;
+            int line;
+            std::chrono::system_clock::time_point timestamp;
+
+            uint16_t file_length;
+            uint16_t message_length;
+
+            char file[FILE_SIZE];
+            char message[MESSAGE_SIZE];
+        };
+
+        std::shared_ptr<log_sink> target;
+        thread_rings<entry, 256> rings;
+
+        std::thread writer;
+        std::atomic_bool running{true};
+        std::atomic_bool pending{false};
+
+        std::atomic<uint64_t> flush_requested{0};
+        std::atomic<uint64_t> flush_completed{0};
+
+        void run();
+    };
+
+    /*
+     * Process-wide level and sink behind the ZNB_LOG_* and debug_print* macros. The runtime level defaults to debug
+     * in DEBUG builds and info otherwise; the default sink is a stream_sink on stdout/stderr.
+     */
+    class logger
+    {
+        static std::atomic<uint8_t> level;
+
+    public:
+        static void set_level(log_level value)
+        {
+            level.store(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] static log_level get_level()
+        {
+            return static_cast<log_level>(level.load(std::memory_order_relaxed));
+        }
+
+        [[nodiscard]] static bool is_enabled(const log_level value)
+        {
+            return value >= level.load(std::memory_order_relaxed) && value != LEVEL_OFF;
+        }
+
+        /*
+         * nullptr restores the default sink. Flushes the previous one.
+         */
+        static void set_sink(std::shared_ptr<log_sink> value);
+
+        [[nodiscard]] static std::shared_ptr<log_sink> get_sink();
+
+        static void write(log_level value, std::string_view file, int line, std::string_view message);
+
+        template <typename... Args>
+        static void log(const log_level value, const std::string_view file, const int line, std::format_string<Args...> format, Args &&...args)
+        {
+            write(value, file, line, std::format(format, std::forward<Args>(args)...));
+        }
+
+        static void flush();
+    };
+}
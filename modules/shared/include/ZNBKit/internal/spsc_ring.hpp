@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace znb_kit
+{
+    inline constexpr size_t cache_line_size = 64;
+
+    /*
+     * Bounded single-producer/single-consumer ring. Capacity has to be a power of two.
+     */
+    template <typename T, size_t Capacity>
+    class spsc_ring
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "spsc_ring capacity has to be a power of two");
+
+        alignas(cache_line_size) std::atomic<size_t> head{0};
+        alignas(cache_line_size) std::atomic<size_t> tail{0};
+        alignas(cache_line_size) std::array<T, Capacity> buffer;
+
+    public:
+        bool push(const T &value)
+        {
+            const size_t current = tail.load(std::memory_order_relaxed);
+
+            if (current - head.load(std::memory_order_acquire) == Capacity)
+            {
+                return false;
+            }
+
+            buffer[current & (Capacity - 1)] = value;
+            tail.store(current + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool pop(T &value)
+        {
+            const size_t current = head.load(std::memory_order_relaxed);
+
+            if (current == tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            value = buffer[current & (Capacity - 1)];
+            head.store(current + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        template <typename Fn>
+        size_t drain(Fn &&fn)
+        {
+            const size_t begin = head.load(std::memory_order_relaxed);
+            const size_t end = tail.load(std::memory_order_acquire);
+
+            for (size_t i = begin; i != end; ++i)
+            {
+                fn(buffer[i & (Capacity - 1)]);
+            }
+
+            head.store(end, std::memory_order_release);
+
+            return end - begin;
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+    };
+
+    /*
+     * A fixed set of SPSC rings, one per producing thread, drained by a single consumer. A thread claims a free slot
+     * with a CAS on its first push and remembers it in a thread-local table keyed by instance. The slot is handed back
+     * when the thread exits (or earlier through release_current()) and becomes free again once the consumer has
+     * drained it. Rings are allocated the first time their slot is used unless they were preallocated, in which case
+     * push never allocates. Pushes from threads beyond the slot count are dropped.
+     */
+    template <typename T, size_t Capacity, size_t Slots = 64>
+    class thread_rings
+    {
+        static constexpr size_t claims_per_thread = 16;
+
+        enum slot_state : uint8_t
+        {
+            FREE,
+            ACTIVE,
+            RETIRED
+        };
+
+        struct slot
+        {
+            std::atomic<uint8_t> state{FREE};
+            std::atomic<spsc_ring<T, Capacity> *> ring{nullptr};
+        };
+
+        /*
+         * Slots outlive the instance for as long as an exiting thread still has to retire one of them.
+         */
+        struct shared_slots
+        {
+            std::array<slot, Slots> slots;
+
+            ~shared_slots()
+            {
+                for (auto &slot : slots)
+                {
+                    delete slot.ring.load(std::memory_order_acquire);
+                }
+            }
+        };
+
+        struct claim_entry
+        {
+            uint64_t owner = 0;
+            slot *claimed = nullptr;
+            std::weak_ptr<shared_slots> lifetime;
+        };
+
+        struct thread_claims
+        {
+            std::array<claim_entry, claims_per_thread> entries;
+
+            ~thread_claims()
+            {
+                for (auto &entry : entries)
+                {
+                    if (const auto alive = entry.lifetime.lock())
+                    {
+                        entry.claimed->state.store(RETIRED, std::memory_order_release);
+                    }
+                }
+            }
+        };
+
+        static inline std::atomic<uint64_t> next_id{1};
+        static inline thread_local thread_claims claims{};
+
+        const uint64_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+        const bool preallocated = false;
+
+        std::shared_ptr<shared_slots> shared = std::make_shared<shared_slots>();
+        std::atomic<size_t> dropped{0};
+
+        slot *claim()
+        {
+            claim_entry *vacant = nullptr;
+
+            for (auto &entry : claims.entries)
+            {
+                if (entry.owner == id)
+                {
+                    return entry.claimed;
+                }
+
+                if (vacant == nullptr && (entry.owner == 0 || entry.lifetime.expired()))
+                {
+                    vacant = &entry;
+                }
+            }
+
+            /*
+             * Every entry belongs to a live instance; claiming without remembering it would leak the slot.
+             */
+            if (vacant == nullptr)
+            {
+                return nullptr;
+            }
+
+            for (auto &slot : shared->slots)
+            {
+                if (preallocated && slot.ring.load(std::memory_order_relaxed) == nullptr)
+                {
+                    break;
+                }
+
+                uint8_t expected = FREE;
+
+                if (slot.state.compare_exchange_strong(expected, ACTIVE, std::memory_order_acq_rel))
+                {
+                    if (slot.ring.load(std::memory_order_acquire) == nullptr)
+                    {
+                        slot.ring.store(new spsc_ring<T, Capacity>(), std::memory_order_release);
+                    }
+
+                    *vacant = {id, &slot, shared};
+                    return &slot;
+                }
+            }
+
+            return nullptr;
+        }
+
+    public:
+        thread_rings() = default;
+
+        /*
+         * Allocates the first 'rings' rings up front and limits the producers to them.
+         */
+        explicit thread_rings(const size_t rings) : preallocated(rings != 0)
+        {
+            for (size_t i = 0; i < std::min(rings, Slots); ++i)
+            {
+                shared->slots[i].ring.store(new spsc_ring<T, Capacity>(), std::memory_order_relaxed);
+            }
+        }
+
+        thread_rings(const thread_rings &) = delete;
+        thread_rings &operator=(const thread_rings &) = delete;
+
+        bool push(const T &value)
+        {
+            slot *slot = claim();
+
+            if (slot == nullptr || !slot->ring.load(std::memory_order_relaxed)->push(value))
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            return true;
+        }
+
+        void release_current()
+        {
+            for (auto &entry : claims.entries)
+            {
+                if (entry.owner == id)
+                {
+                    entry.claimed->state.store(RETIRED, std::memory_order_release);
+                    entry = {};
+
+                    return;
+                }
+            }
+        }
+
+        /*
+         * Single consumer only.
+         */
+        template <typename Fn>
+        size_t drain(Fn &&fn)
+        {
+            size_t drained = 0;
+
+            for (auto &slot : shared->slots)
+            {
+                const uint8_t state = slot.state.load(std::memory_order_acquire);
+                auto *ring = slot.ring.load(std::memory_order_acquire);
+
+                if (state == FREE || ring == nullptr)
+                {
+                    continue;
+                }
+
+                drained += ring->drain(fn);
+
+                if (state == RETIRED && ring->empty())
+                {
+                    slot.state.store(FREE, std::memory_order_release);
+                }
+            }
+
+            return drained;
+        }
+
+        [[nodiscard]] size_t get_dropped() const
+        {
+            return dropped.load(std::memory_order_relaxed);
+        }
+    };
+}
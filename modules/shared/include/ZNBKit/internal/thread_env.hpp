@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <jni.h>
+
+namespace znb_kit
+{
+    /*
+     * JNIEnv of the calling thread, for code that must not hold on to the env it was created with. The JavaVM is set
+     * by vm_object; the env is looked up once per thread and kept in a thread-local cache that is invalidated whenever
+     * the VM changes. Threads unknown to the VM are attached as daemons on first use and detached when they exit.
+     */
+    class thread_env
+    {
+        static std::atomic<JavaVM *> vm;
+        static std::atomic<jint> version;
+        static std::atomic<uint64_t> generation;
+
+        struct cache_entry
+        {
+            uint64_t generation = 0;
+            JNIEnv *env = nullptr;
+
+            bool attached = false;
+
+            /*
+             * Threads attached here are detached again when they exit.
+             */
+            ~cache_entry();
+        };
+
+        static thread_local cache_entry cache;
+
+        static JNIEnv *resolve();
+
+    public:
+        static void set_vm(JavaVM *jvm, jint jni_version);
+
+        /*
+         * Publishes the VM behind `jni` when none is set yet, for code running inside a VM it did not create.
+         */
+        static void adopt(JNIEnv *jni);
+
+        [[nodiscard]] static JavaVM *get_vm()
+        {
+            return vm.load(std::memory_order_acquire);
+        }
+
+        static JNIEnv *get()
+        {
+            if (cache.env != nullptr && cache.generation == generation.load(std::memory_order_acquire))
+            {
+                return cache.env;
+            }
+
+            return resolve();
+        }
+
+        /*
+         * Has to be called by a thread before it detaches itself from the VM.
+         */
+        static void forget()
+        {
+            cache.generation = 0;
+            cache.env = nullptr;
+            cache.attached = false;
+        }
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace znb_kit
+{
+    struct timeline_phase
+    {
+        std::string name;
+        std::string subject;
+
+        std::chrono::nanoseconds start{};
+        std::chrono::nanoseconds duration{};
+
+        size_t count = 0;
+    };
+
+    /*
+     * Process-wide startup timeline. Offsets are measured on the monotonic clock from the moment the library was loaded,
+     * which is the closest point to process start we can observe without platform specific calls.
+     * Only one JVM can exist per process, so a single timeline is enough.
+     */
+    class timeline
+    {
+        static constexpr size_t max_phases = 4096;
+
+        static std::mutex mutex;
+        static std::vector<timeline_phase> phases;
+        static size_t dropped;
+
+        static const std::chrono::steady_clock::time_point origin;
+
+    public:
+        class scope
+        {
+            std::string name;
+            std::string subject;
+            size_t count = 0;
+
+            std::chrono::steady_clock::time_point begin;
+
+        public:
+            explicit scope(std::string name, std::string subject = "");
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+            void set_count(size_t new_count)
+            {
+                count = new_count;
+            }
+
+            ~scope();
+        };
+
+        static void record(const std::string &name, const std::string &subject,
+                           std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end, size_t count = 0);
+
+        static std::vector<timeline_phase> snapshot();
+
+        static size_t dropped_count();
+
+        static void reset();
+
+        static std::string to_json();
+
+        [[nodiscard]] static std::chrono::steady_clock::time_point get_origin()
+        {
+            return origin;
+        }
+    };
+}
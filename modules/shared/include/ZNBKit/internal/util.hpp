@@ -7,6 +7,7 @@
 #include <iostream>
 #include <jni.h>
 #include <string>
+#include <string_view>
 
 namespace znb_kit
 {
@@ -19,4 +20,6 @@ namespace znb_kit
     bool compare_parameters(const std::string &method_name, const std::vector<std::string> &expected, const std::vector<std::string> &probable);
 
     std::vector<jobject> get_methods(JNIEnv *env, const jobject &instance);
+
+    std::string escape_json(std::string_view value);
 }
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <jni.h>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "ZNBKit/internal/wrapper.hpp"
+
+namespace znb_kit
+{
+    /*
+     * Map keyed by Java objects that does not keep its keys alive. Keys are held as tracked weak global refs and
+     * bucketed by System.identityHashCode, which is stable for the lifetime of an object, and compared with
+     * IsSameObject. Entries whose key has been collected stop matching right away and are dropped by purge(), which
+     * hands their values back so the native state behind them can be released.
+     *
+     * Computing the hash is an upcall. Callers that look the same object up repeatedly, or get its identity hash
+     * passed down from Java, hand it in through the overloads taking `identity` and skip the upcall entirely.
+     *
+     * The cache owns JNI references, so it has to be released with release() while the VM is still alive.
+     */
+    template <typename V>
+    class weak_cache
+    {
+        struct entry
+        {
+            jweak key;
+            V value;
+        };
+
+        jclass system_klass = nullptr;
+        jmethodID identity_hash_code = nullptr;
+
+        mutable std::mutex mutex;
+        std::unordered_map<jint, std::vector<entry>> buckets;
+        size_t entries = 0;
+
+    public:
+        explicit weak_cache(JNIEnv *jni)
+        {
+            VAR_CHECK(jni);
+
+            const auto klass = wrapper::search_for_class(jni, "java/lang/System");
+
+            identity_hash_code = wrapper::get_method(jni, klass, "identityHashCode", "(Ljava/lang/Object;)I", true);
+            system_klass = static_cast<jclass>(wrapper::add_global_ref(jni, klass));
+
+            wrapper::remove_local_ref(jni, klass);
+        }
+
+        weak_cache(const weak_cache &) = delete;
+        weak_cache &operator=(const weak_cache &) = delete;
+
+        /*
+         * System.identityHashCode(key), the value the overloads taking `identity` expect.
+         */
+        jint hash(JNIEnv *jni, const jobject &key) const
+        {
+            VAR_CHECK(key);
+
+            const jvalue parameter{.l = key};
+            const jint result = jni->CallStaticIntMethodA(system_klass, identity_hash_code, &parameter);
+
+            EXCEPT_CHECK(jni);
+
+            return result;
+        }
+
+        std::optional<V> get(JNIEnv *jni, const jobject &key) const
+        {
+            return get(jni, key, hash(jni, key));
+        }
+
+        std::optional<V> get(JNIEnv *jni, const jobject &key, const jint identity) const
+        {
+            VAR_CHECK(key);
+
+            std::lock_guard lock(mutex);
+
+            const auto it = buckets.find(identity);
+
+            if (it == buckets.end())
+            {
+                return std::nullopt;
+            }
+
+            for (const auto &entry : it->second)
+            {
+                if (jni->IsSameObject(entry.key, key))
+                {
+                    return entry.value;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        void put(JNIEnv *jni, const jobject &key, V value)
+        {
+            put(jni, key, hash(jni, key), std::move(value));
+        }
+
+        void put(JNIEnv *jni, const jobject &key, const jint identity, V value)
+        {
+            VAR_CHECK(key);
+
+            std::lock_guard lock(mutex);
+
+            auto &chain = buckets[identity];
+
+            for (auto &entry : chain)
+            {
+                if (jni->IsSameObject(entry.key, key))
+                {
+                    entry.value = std::move(value);
+                    return;
+                }
+            }
+
+            chain.push_back({wrapper::add_weak_ref(jni, key), std::move(value)});
+            ++entries;
+        }
+
+        std::optional<V> erase(JNIEnv *jni, const jobject &key)
+        {
+            return erase(jni, key, hash(jni, key));
+        }
+
+        std::optional<V> erase(JNIEnv *jni, const jobject &key, const jint identity)
+        {
+            VAR_CHECK(key);
+
+            std::lock_guard lock(mutex);
+
+            const auto it = buckets.find(identity);
+
+            if (it == buckets.end())
+            {
+                return std::nullopt;
+            }
+
+            auto &chain = it->second;
+
+            for (auto entry = chain.begin(); entry != chain.end(); ++entry)
+            {
+                if (!jni->IsSameObject(entry->key, key))
+                {
+                    continue;
+                }
+
+                std::optional<V> value = std::move(entry->value);
+
+                wrapper::remove_weak_ref(jni, entry->key);
+                chain.erase(entry);
+                --entries;
+
+                if (chain.empty())
+                {
+                    buckets.erase(it);
+                }
+
+                return value;
+            }
+
+            return std::nullopt;
+        }
+
+        /*
+         * Drops every entry whose key has been collected and returns their values.
+         */
+        std::vector<V> purge(JNIEnv *jni)
+        {
+            VAR_CHECK(jni);
+
+            std::vector<V> purged;
+
+            std::lock_guard lock(mutex);
+
+            for (auto it = buckets.begin(); it != buckets.end();)
+            {
+                auto &chain = it->second;
+
+                std::erase_if(chain, [&](entry &entry) {
+                    if (!wrapper::is_cleared(jni, entry.key))
+                    {
+                        return false;
+                    }
+
+                    purged.push_back(std::move(entry.value));
+                    wrapper::remove_weak_ref(jni, entry.key);
+
+                    return true;
+                });
+
+                it = chain.empty() ? buckets.erase(it) : std::next(it);
+            }
+
+            entries -= purged.size();
+
+            return purged;
+        }
+
+        /*
+         * Entries including the ones whose key was collected but not purged yet.
+         */
+        [[nodiscard]] size_t size() const
+        {
+            std::lock_guard lock(mutex);
+            return entries;
+        }
+
+        void release(JNIEnv *jni)
+        {
+            VAR_CHECK(jni);
+
+            std::lock_guard lock(mutex);
+
+            for (auto &chain : buckets)
+            {
+                for (const auto &entry : chain.second)
+                {
+                    wrapper::remove_weak_ref(jni, entry.key);
+                }
+            }
+
+            buckets.clear();
+            entries = 0;
+
+            if (system_klass != nullptr)
+            {
+                wrapper::remove_global_ref(jni, system_klass);
+                system_klass = nullptr;
+            }
+        }
+    };
+}
@@ -4,13 +4,17 @@
 
 #pragma once
 
+#include <expected>
 #include <jni.h>
 #include <mutex>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "ZNBKit/internal/java_error.hpp"
+
 #define VAR_CHECK(param) \
     if (param == nullptr) { \
         throw std::invalid_argument("Variable '" #param "' is null"); \
@@ -28,6 +32,14 @@
         throw std::runtime_error("JNI Exception occurred"); \
 }
 
+/*
+ * Non-throwing counterpart of EXCEPT_CHECK for functions returning std::expected<T, java_error>.
+ */
+#define EXPECT_CHECK(jni) \
+    if (jni->ExceptionCheck()) { \
+        return std::unexpected(znb_kit::java_error::take(jni)); \
+    }
+
 namespace znb_kit
 {
     enum mapping
@@ -191,6 +203,23 @@ namespace znb_kit
         static void dump_refs();
     };
 
+    /*
+     * Weak global references do not keep their referent alive, so they live in a tracker of their own rather than
+     * next to the GC roots in global_tracker.
+     */
+    class weak_tracker
+    {
+    public:
+        static std::mutex mutex;
+        static std::unordered_map<jweak, ref_info> weak_refs;
+
+        static void add(const jweak &ref, const std::string &file = "", int line = 0, const std::string &method = "");
+
+        static void remove(const jweak &ref);
+
+        static size_t count();
+    };
+
     class wrapper
     {
         static std::unordered_map<std::string, size_t> tracked_native_classes;
@@ -203,10 +232,30 @@ namespace znb_kit
                            const std::string &file = __FILE__, int line = __LINE__,
                            const std::string &method = __builtin_FUNCTION());
 
+        /*
+         * Tracks a local ref that JNI already handed out, without creating another one through NewLocalRef.
+         */
+        static jobject adopt_local_ref(JNIEnv *jni, const jobject &obj,
+                                       const std::string &file = __FILE__, int line = __LINE__,
+                                       const std::string &method = __builtin_FUNCTION());
+
         static jobject add_global_ref(JNIEnv *jni, const jobject &obj,
                                     const std::string &file = __FILE__, int line = __LINE__,
                                     const std::string &method = __builtin_FUNCTION());
 
+        static jweak add_weak_ref(JNIEnv *jni, const jobject &obj,
+                                  const std::string &file = __FILE__, int line = __LINE__,
+                                  const std::string &method = __builtin_FUNCTION());
+
+        static void remove_weak_ref(JNIEnv *jni, const jweak &ref);
+
+        /*
+         * Untracked local ref to the referent, or nullptr once it has been collected. Release it with DeleteLocalRef.
+         */
+        static jobject upgrade_weak_ref(JNIEnv *jni, const jweak &ref);
+
+        static bool is_cleared(JNIEnv *jni, const jweak &ref);
+
         static void cleanup_all_refs(JNIEnv* jni);
 
         static void remove_local_ref(JNIEnv *jni, const jobject &obj);
@@ -226,6 +275,9 @@ namespace znb_kit
         static jmethodID get_method(JNIEnv *jni, const std::string &name, const std::string &method,
                                     const std::string &signature, bool is_static);
 
+        static jfieldID get_field(JNIEnv *jni, const jclass &klass, const std::string &field_name,
+                                  const std::string &descriptor, bool is_static);
+
         static jobject invoke_object_method(JNIEnv *jni, const jclass &klass, const jobject &instance,
                                             const jmethodID &method_id, const std::vector<jvalue> &parameters);
 
@@ -250,8 +302,77 @@ namespace znb_kit
         static void invoke_void_method(JNIEnv *jni, const jclass &klass, const jobject &instance, const jmethodID &method_id,
                                        const std::vector<jvalue> &parameters);
 
+        /*
+         * Non-throwing invocation: a Java exception comes back as java_error instead of being described and rethrown
+         * as std::runtime_error. Static when klass is set, like the invoke_*_method family. Object results are tracked
+         * local refs.
+         */
+        template <typename T>
+        static std::expected<T, java_error> try_invoke(JNIEnv *jni, const jclass &klass, const jobject &instance,
+                                                       const jmethodID &method_id, const std::vector<jvalue> &parameters)
+        {
+            VAR_CHECK(jni);
+
+            const jvalue *arguments = parameters.data();
+
+#define TRY_INVOKE_CASE(TYPE, NAME) \
+            if constexpr (std::is_same_v<T, TYPE>) \
+            { \
+                const TYPE result = klass != nullptr \
+                    ? jni->CallStatic##NAME##MethodA(klass, method_id, arguments) \
+                    : jni->Call##NAME##MethodA(instance, method_id, arguments); \
+                EXPECT_CHECK(jni); \
+                return result; \
+            }
+
+            if constexpr (std::is_void_v<T>)
+            {
+                if (klass != nullptr)
+                {
+                    jni->CallStaticVoidMethodA(klass, method_id, arguments);
+                }
+                else
+                {
+                    jni->CallVoidMethodA(instance, method_id, arguments);
+                }
+
+                EXPECT_CHECK(jni);
+
+                return {};
+            }
+            else if constexpr (std::is_convertible_v<T, jobject>)
+            {
+                const jobject result = klass != nullptr
+                    ? jni->CallStaticObjectMethodA(klass, method_id, arguments)
+                    : jni->CallObjectMethodA(instance, method_id, arguments);
+
+                EXPECT_CHECK(jni);
+
+                return static_cast<T>(adopt_local_ref(jni, result, __FILE__, __LINE__, __func__));
+            }
+            else
+            {
+                TRY_INVOKE_CASE(jboolean, Boolean)
+                else TRY_INVOKE_CASE(jbyte, Byte)
+                else TRY_INVOKE_CASE(jchar, Char)
+                else TRY_INVOKE_CASE(jshort, Short)
+                else TRY_INVOKE_CASE(jint, Int)
+                else TRY_INVOKE_CASE(jlong, Long)
+                else TRY_INVOKE_CASE(jfloat, Float)
+                else TRY_INVOKE_CASE(jdouble, Double)
+                else
+                {
+                    static_assert(std::is_void_v<T>, "try_invoke does not support this return type");
+                }
+            }
+
+#undef TRY_INVOKE_CASE
+        }
+
         static void register_natives(JNIEnv *jni, const std::string &klass_name, const jclass &klass, const std::vector<jni_native_method> &methods);
 
         static void unregister_natives(JNIEnv *jni, const std::string &klass_name);
+
+        static size_t unregister_all_natives(JNIEnv *jni);
     };
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "ZNBKit/internal/java_error.hpp"
+
+#include "ZNBKit/internal/thread_env.hpp"
+#include "ZNBKit/internal/util.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+
+namespace znb_kit
+{
+    std::atomic_bool java_error::describe{false};
+
+    java_error::state::~state()
+    {
+        if (throwable != nullptr && thread_env::get_vm() != nullptr)
+        {
+            wrapper::remove_global_ref(thread_env::get(), throwable);
+        }
+    }
+
+    java_error java_error::take(JNIEnv *jni, const bool describe_exception)
+    {
+        VAR_CHECK(jni);
+
+        const jthrowable throwable = jni->ExceptionOccurred();
+
+        /*
+         * ExceptionDescribe clears the exception as well, so it has to be taken first.
+         */
+        if (describe_exception || describe.load(std::memory_order_relaxed))
+        {
+            jni->ExceptionDescribe();
+        }
+
+        jni->ExceptionClear();
+
+        thread_env::adopt(jni);
+
+        java_error result;
+        result.error = std::make_shared<state>();
+
+        if (throwable != nullptr)
+        {
+            result.error->throwable = static_cast<jthrowable>(wrapper::add_global_ref(jni, throwable));
+            jni->DeleteLocalRef(throwable);
+        }
+
+        return result;
+    }
+
+    void java_error::decode(JNIEnv *jni) const
+    {
+        std::call_once(error->decoded, [this, jni] {
+            if (error->throwable == nullptr)
+            {
+                error->klass = "[unknown]";
+                return;
+            }
+
+            JNIEnv *env = jni != nullptr ? jni : thread_env::get();
+
+            if (env->PushLocalFrame(8) != JNI_OK)
+            {
+                env->ExceptionClear();
+                return;
+            }
+
+            const auto throwable_klass = env->GetObjectClass(error->throwable);
+            const auto class_klass = env->GetObjectClass(throwable_klass);
+
+            const auto get_name = env->GetMethodID(class_klass, "getName", "()Ljava/lang/String;");
+            const auto name = get_name != nullptr ? static_cast<jstring>(env->CallObjectMethod(throwable_klass, get_name)) : nullptr;
+
+            if (env->ExceptionCheck())
+            {
+                env->ExceptionClear();
+            }
+            else if (name != nullptr)
+            {
+                error->klass = get_string(env, name);
+            }
+
+            const auto get_message = env->GetMethodID(throwable_klass, "getMessage", "()Ljava/lang/String;");
+            const auto message = get_message != nullptr ? static_cast<jstring>(env->CallObjectMethod(error->throwable, get_message)) : nullptr;
+
+            if (env->ExceptionCheck())
+            {
+                env->ExceptionClear();
+            }
+            else if (message != nullptr)
+            {
+                error->message = get_string(env, message);
+            }
+
+            env->PopLocalFrame(nullptr);
+        });
+    }
+
+    const std::string &java_error::get_class_name(JNIEnv *jni) const
+    {
+        decode(jni);
+        return error->klass;
+    }
+
+    const std::string &java_error::get_message(JNIEnv *jni) const
+    {
+        decode(jni);
+        return error->message;
+    }
+
+    bool java_error::is_instance_of(JNIEnv *jni, const jclass &klass) const
+    {
+        VAR_CHECK(jni);
+
+        return error->throwable != nullptr && jni->IsInstanceOf(error->throwable, klass);
+    }
+
+    void java_error::rethrow(JNIEnv *jni) const
+    {
+        VAR_CHECK(jni);
+
+        if (error->throwable != nullptr)
+        {
+            jni->Throw(error->throwable);
+        }
+    }
+
+    void java_error::print(JNIEnv *jni) const
+    {
+        rethrow(jni);
+
+        if (jni->ExceptionCheck())
+        {
+            jni->ExceptionDescribe();
+            jni->ExceptionClear();
+        }
+    }
+}
@@ -0,0 +1,247 @@
+#include "ZNBKit/internal/logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/wrapper.hpp"
+
+namespace
+{
+    std::shared_ptr<znb_kit::log_sink> make_default_sink()
+    {
+#ifdef DEBUG
+        return std::make_shared<znb_kit::stream_sink>(stdout, stderr, true);
+#else
+        return std::make_shared<znb_kit::stream_sink>(stdout, stderr, false);
+#endif
+    }
+
+    /*
+     * Leaked on purpose, so static destructors running late can still log.
+     */
+    std::atomic<std::shared_ptr<znb_kit::log_sink>> &get_sink_slot()
+    {
+        static auto *slot = new std::atomic<std::shared_ptr<znb_kit::log_sink>>(make_default_sink());
+        return *slot;
+    }
+
+    std::string_view get_location(const std::string_view file)
+    {
+        if (const auto path = get_path(file); !path.empty())
+        {
+            return path;
+        }
+
+        const auto separator = file.find_last_of('/');
+
+        return separator == std::string_view::npos ? file : file.substr(separator + 1);
+    }
+
+    size_t copy_truncated(char *destination, const size_t capacity, const std::string_view source)
+    {
+        const size_t length = std::min(source.size(), capacity);
+        std::memcpy(destination, source.data(), length);
+
+        return length;
+    }
+}
+
+namespace znb_kit
+{
+#ifdef DEBUG
+    std::atomic<uint8_t> logger::level{LEVEL_DEBUG};
+#else
+    std::atomic<uint8_t> logger::level{LEVEL_INFO};
+#endif
+
+    std::string_view get_level_name(const log_level level)
+    {
+        switch (level)
+        {
+        case LEVEL_DEBUG:
+            return "DEBUG";
+        case LEVEL_INFO:
+            return "INFO";
+        case LEVEL_WARN:
+            return "WARN";
+        case LEVEL_ERROR:
+            return "ERROR";
+        case LEVEL_OFF:
+            break;
+        }
+
+        return "OFF";
+    }
+
+    stream_sink::stream_sink(FILE *out, FILE *err, const bool with_location) : out(out), err(err), with_location(with_location)
+    {
+        VAR_CHECK(out);
+        VAR_CHECK(err);
+    }
+
+    void stream_sink::write(const log_record &record)
+    {
+        FILE *stream = record.level >= LEVEL_WARN ? err : out;
+        const auto level = get_level_name(record.level);
+
+        if (with_location)
+        {
+            const auto location = get_location(record.file);
+
+            fprintf(stream, "[%.*s] %.*s:%d %.*s\n", static_cast<int>(level.size()), level.data(),
+                static_cast<int>(location.size()), location.data(), record.line,
+                static_cast<int>(record.message.size()), record.message.data());
+        }
+        else
+        {
+            fprintf(stream, "[%.*s] %.*s\n", static_cast<int>(level.size()), level.data(),
+                static_cast<int>(record.message.size()), record.message.data());
+        }
+    }
+
+    void stream_sink::flush()
+    {
+        fflush(out);
+        fflush(err);
+    }
+
+    async_sink::async_sink(std::shared_ptr<log_sink> target) : target(std::move(target))
+    {
+        VAR_CHECK(this->target);
+
+        writer = std::thread(&async_sink::run, this);
+    }
+
+    async_sink::~async_sink()
+    {
+        running.store(false);
+        pending.store(true);
+        pending.notify_one();
+
+        if (writer.joinable())
+        {
+            writer.join();
+        }
+
+        target->flush();
+    }
+
+    void async_sink::write(const log_record &record)
+    {
+        entry item;
+        item.level = record.level;
+        item.line = record.line;
+        item.timestamp = record.timestamp;
+        item.file_length = static_cast<uint16_t>(copy_truncated(item.file, FILE_SIZE, record.file));
+        item.message_length = static_cast<uint16_t>(copy_truncated(item.message, MESSAGE_SIZE, record.message));
+
+        if (!rings.push(item))
+        {
+            return;
+        }
+
+        if (!pending.exchange(true, std::memory_order_acq_rel))
+        {
+            pending.notify_one();
+        }
+    }
+
+    void async_sink::flush()
+    {
+        const uint64_t request = flush_requested.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+        pending.store(true, std::memory_order_release);
+        pending.notify_one();
+
+        for (uint64_t completed = flush_completed.load(std::memory_order_acquire); completed < request;
+             completed = flush_completed.load(std::memory_order_acquire))
+        {
+            flush_completed.wait(completed, std::memory_order_acquire);
+        }
+    }
+
+    void async_sink::release_current()
+    {
+        rings.release_current();
+    }
+
+    void async_sink::run()
+    {
+        while (true)
+        {
+            pending.store(false, std::memory_order_release);
+
+            /*
+             * One pass reads every ring's tail after the request was seen, so it covers everything queued before the
+             * flush() call even while other threads keep logging.
+             */
+            const uint64_t requested = flush_requested.load(std::memory_order_acquire);
+
+            const size_t drained = rings.drain([this](const entry &item) {
+                target->write({
+                    item.level,
+                    item.timestamp,
+                    std::string_view(item.file, item.file_length),
+                    item.line,
+                    std::string_view(item.message, item.message_length)
+                });
+            });
+
+            if (requested != flush_completed.load(std::memory_order_relaxed))
+            {
+                target->flush();
+
+                flush_completed.store(requested, std::memory_order_release);
+                flush_completed.notify_all();
+            }
+
+            if (drained != 0)
+            {
+                continue;
+            }
+
+            if (!running.load())
+            {
+                break;
+            }
+
+            pending.wait(false, std::memory_order_acquire);
+        }
+    }
+
+    void logger::set_sink(std::shared_ptr<log_sink> value)
+    {
+        if (value == nullptr)
+        {
+            value = make_default_sink();
+        }
+
+        if (const auto previous = get_sink_slot().exchange(std::move(value)))
+        {
+            previous->flush();
+        }
+    }
+
+    std::shared_ptr<log_sink> logger::get_sink()
+    {
+        return get_sink_slot().load(std::memory_order_acquire);
+    }
+
+    void logger::write(const log_level value, const std::string_view file, const int line, const std::string_view message)
+    {
+        if (const auto target = get_sink())
+        {
+            target->write({value, std::chrono::system_clock::now(), file, line, message});
+        }
+    }
+
+    void logger::flush()
+    {
+        if (const auto target = get_sink())
+        {
+            target->flush();
+        }
+    }
+}
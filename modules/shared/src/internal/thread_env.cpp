@@ -0,0 +1,93 @@
+#include "ZNBKit/internal/thread_env.hpp"
+
+#include <stdexcept>
+
+namespace znb_kit
+{
+    std::atomic<JavaVM *> thread_env::vm{nullptr};
+    std::atomic<jint> thread_env::version{JNI_VERSION_1_8};
+    std::atomic<uint64_t> thread_env::generation{1};
+
+    thread_local thread_env::cache_entry thread_env::cache;
+
+    thread_env::cache_entry::~cache_entry()
+    {
+        if (!attached || generation != thread_env::generation.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        if (JavaVM *jvm = vm.load(std::memory_order_acquire); jvm != nullptr)
+        {
+            jvm->DetachCurrentThread();
+        }
+    }
+
+    void thread_env::set_vm(JavaVM *jvm, const jint jni_version)
+    {
+        version.store(jni_version, std::memory_order_relaxed);
+        vm.store(jvm, std::memory_order_release);
+        generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    void thread_env::adopt(JNIEnv *jni)
+    {
+        if (jni == nullptr || vm.load(std::memory_order_acquire) != nullptr)
+        {
+            return;
+        }
+
+        JavaVM *jvm = nullptr;
+
+        if (jni->GetJavaVM(&jvm) == JNI_OK && jvm != nullptr)
+        {
+            JavaVM *expected = nullptr;
+
+            version.store(jni->GetVersion(), std::memory_order_relaxed);
+
+            if (vm.compare_exchange_strong(expected, jvm, std::memory_order_acq_rel))
+            {
+                generation.fetch_add(1, std::memory_order_acq_rel);
+            }
+        }
+    }
+
+    JNIEnv *thread_env::resolve()
+    {
+        const uint64_t current = generation.load(std::memory_order_acquire);
+        JavaVM *jvm = vm.load(std::memory_order_acquire);
+
+        if (jvm == nullptr)
+        {
+            throw std::runtime_error("No JavaVM is available for this thread");
+        }
+
+        JNIEnv *env = nullptr;
+        bool attached = false;
+
+        const jint jni_version = version.load(std::memory_order_relaxed);
+
+        if (const auto result = jvm->GetEnv(reinterpret_cast<void **>(&env), jni_version); result == JNI_EDETACHED)
+        {
+            if (jvm->AttachCurrentThreadAsDaemon(reinterpret_cast<void **>(&env), nullptr) != JNI_OK)
+            {
+                throw std::runtime_error("Failed to attach thread to the JavaVM");
+            }
+
+            attached = true;
+        }
+        else if (result != JNI_OK)
+        {
+            throw std::runtime_error("Failed to get JNIEnv for this thread");
+        }
+
+        /*
+         * A thread attached under an older VM generation counts as ours as well.
+         */
+        cache.generation = current;
+        cache.env = env;
+        cache.attached = cache.attached || attached;
+
+        return env;
+    }
+}
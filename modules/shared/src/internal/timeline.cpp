@@ -0,0 +1,77 @@
+#include "ZNBKit/internal/timeline.hpp"
+
+#include <format>
+
+#include "ZNBKit/internal/util.hpp"
+
+namespace znb_kit
+{
+    std::mutex timeline::mutex;
+    std::vector<timeline_phase> timeline::phases;
+    size_t timeline::dropped = 0;
+
+    const std::chrono::steady_clock::time_point timeline::origin = std::chrono::steady_clock::now();
+
+    timeline::scope::scope(std::string name, std::string subject)
+        : name(std::move(name)), subject(std::move(subject)), begin(std::chrono::steady_clock::now())
+    {
+    }
+
+    timeline::scope::~scope()
+    {
+        record(name, subject, begin, std::chrono::steady_clock::now(), count);
+    }
+
+    void timeline::record(const std::string &name, const std::string &subject,
+                          const std::chrono::steady_clock::time_point begin, const std::chrono::steady_clock::time_point end, const size_t count)
+    {
+        std::lock_guard lock(mutex);
+
+        if (phases.size() >= max_phases)
+        {
+            ++dropped;
+            return;
+        }
+
+        phases.push_back({name, subject, begin - origin, end - begin, count});
+    }
+
+    std::vector<timeline_phase> timeline::snapshot()
+    {
+        std::lock_guard lock(mutex);
+        return phases;
+    }
+
+    size_t timeline::dropped_count()
+    {
+        std::lock_guard lock(mutex);
+        return dropped;
+    }
+
+    void timeline::reset()
+    {
+        std::lock_guard lock(mutex);
+
+        phases.clear();
+        dropped = 0;
+    }
+
+    std::string timeline::to_json()
+    {
+        const auto phases_copy = snapshot();
+
+        std::string json = std::format("{{\"dropped\":{},\"phases\":[", dropped_count());
+
+        for (size_t i = 0; i < phases_copy.size(); ++i)
+        {
+            const auto &[name, subject, start, duration, count] = phases_copy[i];
+
+            json += std::format("{}{{\"name\":\"{}\",\"subject\":\"{}\",\"start_ns\":{},\"duration_ns\":{},\"count\":{}}}",
+                i == 0 ? "" : ",", escape_json(name), escape_json(subject), start.count(), duration.count(), count);
+        }
+
+        json += "]}";
+
+        return json;
+    }
+}
@@ -8,6 +8,7 @@
 #include <unordered_set>
 
 #include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/local_ref.hpp"
 #include "ZNBKit/internal/wrapper.hpp"
 
 namespace znb_kit
@@ -21,20 +22,18 @@ namespace znb_kit
             return {};
         }
 
-        const auto array = reinterpret_cast<jobjectArray>(wrapper::invoke_object_method(env, nullptr, instance, method_id, {}));
-        const auto array_size = env->GetArrayLength(array);
+        const auto array = invoke_object<jobjectArray>(env, nullptr, instance, method_id, {});
+        const auto array_size = env->GetArrayLength(array.get());
 
         std::vector<jobject> methods(array_size);
 
         for (int i = 0; i < array_size; ++i)
         {
-            methods[i] = env->GetObjectArrayElement(array, i);
+            methods[i] = env->GetObjectArrayElement(array.get(), i);
 
             EXCEPT_CHECK(env);
         }
 
-        wrapper::remove_local_ref(env, array);
-
         return methods;
     }
 
@@ -73,42 +72,33 @@ namespace znb_kit
         const auto getParameterTypes_method_id  = wrapper::get_method(env, "java/lang/reflect/Method", "getParameterTypes", "()[Ljava/lang/Class;", false);
         const auto getTypeName_method_id = wrapper::get_method(env, "java/lang/Class", "getTypeName", "()Ljava/lang/String;", false);
 
-        const auto array = reinterpret_cast<jobjectArray>(wrapper::invoke_object_method(env, nullptr, instance, getParameterTypes_method_id, {}));
-        const auto array_size = env->GetArrayLength(array);
+        const auto array = invoke_object<jobjectArray>(env, nullptr, instance, getParameterTypes_method_id, {});
+        const auto array_size = env->GetArrayLength(array.get());
 
         std::vector<std::string> methods(array_size);
 
         for (int i = 0; i < array_size; ++i)
         {
-
-            const auto element = env->GetObjectArrayElement(array, i);
-
-            EXCEPT_CHECK(env);
-
-            const auto jstr = reinterpret_cast<jstring>(wrapper::invoke_object_method(env, nullptr, element, getTypeName_method_id, {}));
+            const local_ref element(env, env->GetObjectArrayElement(array.get(), i));
 
             EXCEPT_CHECK(env);
 
-            const auto key = get_string(env, jstr);
-            methods[i] = key;
+            const auto jstr = invoke_object<jstring>(env, nullptr, element.get(), getTypeName_method_id, {});
 
-            wrapper::remove_local_ref(env, jstr);
-            wrapper::remove_local_ref(env, element);
+            methods[i] = get_string(env, jstr.get());
         }
 
-        wrapper::remove_local_ref(env, array);
-
         return methods;
     }
 
     bool compare_parameters(const std::string &method_name, const std::vector<std::string> &expected, const std::vector<std::string> &probable)
     {
         if (expected.size() != probable.size()) {
-            debug_print("[JNI] For '" + method_name + "' occurred mismatch, with expected size of: " + std::to_string(expected.size()) + " and received " + std::to_string(probable.size()));
+            ZNB_LOG_DEBUG("[JNI] For '{}' occurred mismatch, with expected size of: {} and received {}", method_name, expected.size(), probable.size());
 
             for (const auto& parameter : probable)
             {
-                debug_print("[JNI] Received parameter: " + parameter);
+                ZNB_LOG_DEBUG("[JNI] Received parameter: {}", parameter);
             }
 
             return false;
@@ -116,12 +106,48 @@ namespace znb_kit
 
         for (size_t i = 0; i < expected.size(); ++i) {
             if (expected[i] != probable[i]) {
-                debug_print_cerr("[JNI] For '" + method_name + "' occurred a mismatch at position " + std::to_string(i) + " which evaluates to: '" + probable[i] + "' instead of expected '" + expected[i] + "'.");
+                ZNB_LOG_DEBUG("[JNI] For '{}' occurred a mismatch at position {} which evaluates to: '{}' instead of expected '{}'.", method_name, i, probable[i], expected[i]);
                 return false;
             }
         }
 
-        debug_print("[JNI] For method '" + method_name + "' all parameters match, with compared amount of: " + std::to_string(expected.size()) + ".");
+        ZNB_LOG_DEBUG("[JNI] For method '{}' all parameters match, with compared amount of: {}.", method_name, expected.size());
         return true;
     }
+
+    std::string escape_json(const std::string_view value)
+    {
+        std::string result;
+        result.reserve(value.size());
+
+        for (const char c : value)
+        {
+            switch (c)
+            {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    result += std::format("\\u{:04x}", static_cast<int>(c));
+                }
+                else
+                {
+                    result += c;
+                }
+            }
+        }
+
+        return result;
+    }
 }
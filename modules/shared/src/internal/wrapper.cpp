@@ -6,17 +6,22 @@
 
 #include <vector>
 #include <cassert>
+#include <ranges>
 
 #include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/timeline.hpp"
 
 namespace znb_kit
 {
     std::mutex global_tracker::mutex;
+    std::mutex weak_tracker::mutex;
     std::mutex wrapper::tracked_native_classes_mutex;
 
     std::unordered_set<jobject> global_tracker::global_refs;
     std::unordered_map<jobject, ref_info> global_tracker::global_ref_sources;
 
+    std::unordered_map<jweak, ref_info> weak_tracker::weak_refs;
+
     std::unordered_map<std::string, size_t> wrapper::tracked_native_classes;
 
     void global_tracker::add(const jobject &ref, const std::string &file, const int line, const std::string &method)
@@ -91,11 +96,38 @@ namespace znb_kit
         }
     }
 
+    void weak_tracker::add(const jweak &ref, const std::string &file, const int line, const std::string &method)
+    {
+        std::lock_guard lock(mutex);
+
+        if (ref != nullptr)
+        {
+            weak_refs[ref] = {file, line, method};
+        }
+    }
+
+    void weak_tracker::remove(const jweak &ref)
+    {
+        std::lock_guard lock(mutex);
+        weak_refs.erase(ref);
+    }
+
+    size_t weak_tracker::count()
+    {
+        std::lock_guard lock(mutex);
+        return weak_refs.size();
+    }
+
     void wrapper::check_for_corruption()
     {
         const bool is_global_empty = global_tracker::count() == 0;
         const bool is_local_empty = local_refs.empty();
 
+        if (const size_t weak_count = weak_tracker::count(); weak_count != 0)
+        {
+            debug_print_cerr(std::format("[WRAPPER] Warning: {} weak global references were not deleted.", weak_count));
+        }
+
         bool are_natives_empty;
 
         std::vector<std::pair<std::string, size_t>> tracked_native_classes_copy;
@@ -113,8 +145,8 @@ namespace znb_kit
         {
             debug_print_cerr("[WRAPPER] Warning: References are not empty.");
 
-            debug_print_cerr(std::format("[WRAPPER] Global references count: {}", std::to_string(global_tracker::count())));
-            debug_print_cerr(std::format("[WRAPPER] Local references count: {}", local_refs.size()));
+            ZNB_LOG_INFO("[WRAPPER] Global references count: {}", global_tracker::count());
+            ZNB_LOG_INFO("[WRAPPER] Local references count: {}", local_refs.size());
 
             if (!is_global_empty)
             {
@@ -144,7 +176,7 @@ namespace znb_kit
             return;
         }
 
-        debug_print_cerr("[WRAPPER] No references left. All good i think, unless not using wrapper, then well, you are on your own. :>");
+        debug_print("[WRAPPER] No references left. All good i think, unless not using wrapper, then well, you are on your own. :>");
     }
 
     void wrapper::dump_local_refs()
@@ -187,6 +219,21 @@ namespace znb_kit
         return ref;
     }
 
+    jobject wrapper::adopt_local_ref(JNIEnv *jni, const jobject &obj,
+                                     const std::string &file, int line,
+                                     const std::string &method)
+    {
+        VAR_CHECK(jni);
+
+        if (obj)
+        {
+            local_refs.insert(obj);
+            local_ref_sources[obj] = {file, line, method};
+        }
+
+        return obj;
+    }
+
     void wrapper::remove_local_ref(JNIEnv *jni, const jobject &obj)
     {
         VAR_CHECK(jni);
@@ -215,10 +262,76 @@ namespace znb_kit
         return ref;
     }
 
+    jweak wrapper::add_weak_ref(JNIEnv *jni, const jobject &obj,
+                                const std::string &file, int line,
+                                const std::string &method)
+    {
+        VAR_CHECK(jni);
+
+        const auto ref = jni->NewWeakGlobalRef(obj);
+
+        if (ref)
+        {
+            weak_tracker::add(ref, file, line, method);
+        }
+
+        return ref;
+    }
+
+    void wrapper::remove_weak_ref(JNIEnv *jni, const jweak &ref)
+    {
+        VAR_CHECK(jni);
+
+        if (ref)
+        {
+            weak_tracker::remove(ref);
+            jni->DeleteWeakGlobalRef(ref);
+        }
+    }
+
+    jobject wrapper::upgrade_weak_ref(JNIEnv *jni, const jweak &ref)
+    {
+        VAR_CHECK(jni);
+
+        if (ref == nullptr)
+        {
+            return nullptr;
+        }
+
+        /*
+         * NewLocalRef on a cleared weak ref returns null, which makes the check and the upgrade a single atomic step.
+         */
+        return jni->NewLocalRef(ref);
+    }
+
+    bool wrapper::is_cleared(JNIEnv *jni, const jweak &ref)
+    {
+        VAR_CHECK(jni);
+
+        return ref == nullptr || jni->IsSameObject(ref, nullptr);
+    }
+
     void wrapper::cleanup_all_refs(JNIEnv *jni)
     {
         VAR_CHECK(jni);
 
+        std::vector<jweak> weak_refs_to_delete;
+        {
+            std::lock_guard lock(weak_tracker::mutex);
+
+            for (const auto &ref : weak_tracker::weak_refs | std::views::keys)
+            {
+                weak_refs_to_delete.push_back(ref);
+            }
+
+            weak_tracker::weak_refs.clear();
+        }
+
+        for (const jweak &ref : weak_refs_to_delete)
+        {
+            jni->DeleteWeakGlobalRef(ref);
+        }
+
         std::vector<jobject> refs_to_delete;
         {
             std::lock_guard lock(global_tracker::mutex);
@@ -249,7 +362,7 @@ namespace znb_kit
             }
         }
 
-        debug_print(std::format("[WRAPPER] Cleaned up {} global references during JVM shutdown", std::to_string(cleanup_count)));
+        ZNB_LOG_DEBUG("[WRAPPER] Cleaned up {} global references during JVM shutdown", cleanup_count);
     }
 
     void wrapper::remove_global_ref(JNIEnv *jni, const jobject &obj)
@@ -336,6 +449,38 @@ namespace znb_kit
         return method_id;
     }
 
+    jfieldID wrapper::get_field(JNIEnv *jni, const jclass &klass, const std::string &field_name,
+                                const std::string &descriptor, const bool is_static)
+    {
+        VAR_CHECK(jni);
+        VAR_CHECK(klass);
+
+        VAR_CONTENT_CHECK(field_name);
+        VAR_CONTENT_CHECK(descriptor);
+
+        jfieldID field = nullptr;
+
+        if (is_static)
+        {
+            field = jni->GetStaticFieldID(klass, field_name.c_str(), descriptor.c_str());
+        }
+        else
+        {
+            field = jni->GetFieldID(klass, field_name.c_str(), descriptor.c_str());
+        }
+
+        EXCEPT_CHECK(jni);
+
+        if (field == nullptr)
+        {
+            throw std::runtime_error(
+                "Field not found: " + field_name + " with descriptor: " + descriptor + " and static val: " +
+                std::to_string(is_static));
+        }
+
+        return field;
+    }
+
     jobject wrapper::invoke_object_method(JNIEnv *jni, const jclass &klass, const jobject &instance,
                                           const jmethodID &method_id, const std::vector<jvalue> &parameters)
     {
@@ -356,7 +501,7 @@ namespace znb_kit
 
         EXCEPT_CHECK(jni);
 
-        return add_local_ref(jni, result, __FILE__, __LINE__, __func__);
+        return adopt_local_ref(jni, result, __FILE__, __LINE__, __func__);
     }
 
     jbyte wrapper::invoke_byte_method(JNIEnv *jni, const jclass &klass, const jobject &instance,
@@ -535,6 +680,38 @@ namespace znb_kit
         tracked_native_classes.erase(klass_name);
     }
 
+    size_t wrapper::unregister_all_natives(JNIEnv *jni)
+    {
+        VAR_CHECK(jni);
+
+        std::vector<std::string> klass_names;
+        {
+            std::lock_guard lock(tracked_native_classes_mutex);
+
+            for (const auto &name : tracked_native_classes | std::views::keys)
+            {
+                klass_names.push_back(name);
+            }
+        }
+
+        size_t unregistered = 0;
+
+        for (const auto &klass_name : klass_names)
+        {
+            try
+            {
+                unregister_natives(jni, klass_name);
+                ++unregistered;
+            }
+            catch (const std::exception &e)
+            {
+                debug_print_cerr(std::format("[WRAPPER] Unable to unregister natives of '{}': {}", klass_name, e.what()));
+            }
+        }
+
+        return unregistered;
+    }
+
     void wrapper::register_natives(JNIEnv *jni, const std::string &klass_name, const jclass &klass,
                                    const std::vector<jni_native_method> &methods_vec)
     {
@@ -542,9 +719,11 @@ namespace znb_kit
         VAR_CHECK(klass);
         VAR_CONTENT_CHECK(klass_name);
 
+        timeline::scope phase("register_natives", klass_name);
+
         if (methods_vec.empty())
         {
-            debug_print_cerr("[WRAPPER] No methods to register for class " + klass_name);
+            ZNB_LOG_DEBUG("[WRAPPER] No methods to register for class {}", klass_name);
             return;
         }
 
@@ -557,9 +736,8 @@ namespace znb_kit
                 method_descriptor.signature_buffer.empty() || method_descriptor.signature_buffer.front() == '\0' ||
                 !method_descriptor.fn_ptr)
             {
-                debug_print_cerr(
-                    "[WRAPPER] Skipping registration of invalid method for class '" + klass_name +
-                    "': Name empty or invalid, Sig empty or invalid, or Func ptr null.");
+                ZNB_LOG_INFO("[WRAPPER] Skipping registration of invalid method for class '{}': Name empty or invalid, Sig empty or invalid, or Func ptr null.",
+                    klass_name);
 
                 continue;
             }
@@ -571,42 +749,32 @@ namespace znb_kit
             });
         }
 
-        std::string message;
-
         if (jni_methods_for_jni_call.empty())
         {
-            message = std::format("[WRAPPER] No valid methods to register for class '{}' after filtering. Original count: {}",
-                                       klass_name, std::to_string(methods_vec.size()));
-            debug_print_cerr(message);
+            ZNB_LOG_INFO("[WRAPPER] No valid methods to register for class '{}' after filtering. Original count: {}",
+                klass_name, methods_vec.size());
 
             return;
         }
 
-
-        message = std::format("[WRAPPER] Registering {} native methods for class '{}'",
-            std::to_string(jni_methods_for_jni_call.size()), klass_name);
-        debug_print(message);
+        ZNB_LOG_DEBUG("[WRAPPER] Registering {} native methods for class '{}'", jni_methods_for_jni_call.size(), klass_name);
 
         const jint register_result = jni->RegisterNatives(klass, jni_methods_for_jni_call.data(),
                                                     static_cast<jint>(jni_methods_for_jni_call.size()));
 
         if (register_result != 0)
         {
-            message = std::format(
-                "[WRAPPER] RegisterNatives failed for class '{}' with error code: {}", klass_name, register_result);
-
-            debug_print_cerr(message);
+            ZNB_LOG_WARN("[WRAPPER] RegisterNatives failed for class '{}' with error code: {}", klass_name, register_result);
         }
         else
         {
-            message = std::format("[WRAPPER] Successfully registered {} native methods for class '{}'",
-                std::to_string(jni_methods_for_jni_call.size()), klass_name);
-
-            debug_print(message);
+            ZNB_LOG_DEBUG("[WRAPPER] Successfully registered {} native methods for class '{}'", jni_methods_for_jni_call.size(), klass_name);
         }
 
         EXCEPT_CHECK(jni);
 
+        phase.set_count(jni_methods_for_jni_call.size());
+
         std::lock_guard lock(tracked_native_classes_mutex);
         tracked_native_classes[klass_name] = jni_methods_for_jni_call.size();
     }
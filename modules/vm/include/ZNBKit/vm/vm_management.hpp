@@ -4,11 +4,15 @@
 
 #pragma once
 
+#include <chrono>
 #include <filesystem>
+#include <functional>
 #include <jni.h>
 #include <jvmti.h>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "ZNBKit/vm/vm_object.hpp"
 
@@ -23,6 +27,11 @@ namespace znb_kit
             {
                 bool can_get_bytecodes = false;
                 bool can_hook = false;
+                bool can_observe_compilation = false;
+                bool can_sample_allocations = false;
+                bool can_tag_objects = false;
+                bool can_observe_gc = false;
+                bool can_observe_object_free = false;
             };
 
             int version = JVMTI_VERSION_1_2;
@@ -30,11 +39,80 @@ namespace znb_kit
             jvmti_capabilities capabilities = {};
         };
 
+        /*
+         * Application class-data sharing. The archive is keyed by the classpath entries (path, size and modification time)
+         * and the VM options, so a changed jar maps to a different archive file and triggers a new training run. JVM version
+         * changes are handled by the VM itself through -XX:+AutoCreateSharedArchive, which regenerates an incompatible archive
+         * at exit. Archives live in '<directory>/<name>-<classpath and options hash>/', and only stale archives of that
+         * subdirectory are removed.
+         */
+        struct cds_data
+        {
+            std::filesystem::path directory;
+            std::string name = "znb";
+        };
+
+        /*
+         * Classes to load and initialize before the VM is handed out. Names may use either the binary ('a.b.C') or the
+         * internal ('a/b/C') form. The manifest is a plain list with one class per line, see record_preload_manifest().
+         */
+        struct preload_data
+        {
+            std::vector<std::string> classes;
+            std::optional<std::filesystem::path> manifest;
+
+            size_t threads = 4;
+        };
+
         struct vm_data
         {
             int version = JNI_VERSION_1_2;
 
             std::optional<std::string> classpath;
+
+            /*
+             * Passed to JNI_CreateJavaVM as they are. They take part in the CDS archive key, since the VM rejects an
+             * archive dumped under a different heap or GC configuration.
+             */
+            std::vector<std::string> options;
+
+            std::optional<cds_data> cds;
+            std::optional<preload_data> preload;
+        };
+
+        /*
+         * GRACEFUL deletes tracked references and waits up to `timeout` for DestroyJavaVM (which blocks on every non-daemon thread).
+         * FAST leaves references and trackers as they are, detaches the calling thread and never destroys the VM, for processes
+         * that are about to exit anyway. Both modes run the registered hooks and unregister the tracked natives first.
+         */
+        struct shutdown_data
+        {
+            enum shutdown_mode
+            {
+                GRACEFUL,
+                FAST
+            };
+
+            shutdown_mode mode = GRACEFUL;
+
+            std::chrono::milliseconds timeout{5000};
+            std::chrono::milliseconds hook_deadline{1000};
+        };
+
+        struct shutdown_report
+        {
+            shutdown_data::shutdown_mode mode = shutdown_data::GRACEFUL;
+            std::chrono::nanoseconds duration{};
+
+            size_t hooks_run = 0;
+            size_t hooks_timed_out = 0;
+            size_t natives_unregistered = 0;
+            size_t references_deleted = 0;
+
+            bool destroyed = false;
+            bool timed_out = false;
+
+            std::vector<std::string> skipped;
         };
 
         static std::unique_ptr<vm_object> create_and_wrap_vm(const std::string &classpath);
@@ -45,10 +123,47 @@ namespace znb_kit
 
         static void cleanup_vm(JavaVM *vm);
 
+        /*
+         * Hooks run on helper threads in registration order. A hook that misses its deadline is abandoned, not interrupted.
+         */
+        static void add_shutdown_hook(const std::string &name, const std::function<void()> &hook,
+                                      std::optional<std::chrono::milliseconds> deadline = std::nullopt);
+
+        static shutdown_report shutdown_vm(std::unique_ptr<vm_object> vm, const shutdown_data &shutdown_data);
+
+        /*
+         * Picks the archive for this classpath and these options, sweeps stale ones and appends the CDS options for
+         * the VM to `options`. The reported mode is REUSE when the archive exists, TRAINING when it has to be dumped
+         * and DISABLED without a classpath.
+         */
+        static startup_report prepare_cds(const cds_data &cds_data, const vm_data &vm_data, std::vector<std::string> &options);
+
+        /*
+         * Downgrades REUSE to TRAINING when the archive was dumped by another JVM version, then records the running one.
+         */
+        static void verify_cds(JNIEnv *jni, startup_report &report);
+
+        static std::vector<preload_result> preload_classes(JavaVM *vm, int version, const preload_data &preload_data);
+
+        /*
+         * Writes every class currently loaded by a non-bootstrap class loader, so the next start can preload them. Requires JVMTI.
+         */
+        static size_t record_preload_manifest(const vm_object &vm, const std::filesystem::path &path);
+
     private:
+        struct shutdown_hook
+        {
+            std::string name;
+            std::function<void()> hook;
+            std::optional<std::chrono::milliseconds> deadline;
+        };
+
+        static std::mutex shutdown_hooks_mutex;
+        static std::vector<shutdown_hook> shutdown_hooks;
+
         static jvmtiCapabilities get_capabilities(const jvmtiEnv *jvmti, jvmti_data data);
 
-        static std::pair<JavaVM *, JNIEnv *> create_vm(const vm_data &vm_data);
+        static std::pair<JavaVM *, JNIEnv *> create_vm(const vm_data &vm_data, const std::vector<std::string> &extra_options);
 
         static jvmtiEnv *get_jvmti(JavaVM *vm, int version);
 
@@ -4,20 +4,57 @@
 
 #pragma once
 
+#include <chrono>
+#include <filesystem>
 #include <jni.h>
 #include <optional>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
+#include "ZNBKit/internal/thread_env.hpp"
+#include "ZNBKit/internal/timeline.hpp"
 #include "ZNBKit/jvmti/jvmti_object.hpp"
 
 namespace znb_kit
 {
+    struct preload_result
+    {
+        std::string name;
+        std::chrono::nanoseconds duration{};
+
+        bool loaded = false;
+        std::string error;
+    };
+
+    struct startup_report
+    {
+        enum cds_mode
+        {
+            DISABLED,
+            TRAINING,
+            REUSE
+        };
+
+        cds_mode cds = DISABLED;
+        std::filesystem::path archive;
+
+        std::chrono::steady_clock::time_point started_at = std::chrono::steady_clock::now();
+        std::chrono::nanoseconds startup{};
+
+        std::optional<std::chrono::nanoseconds> first_call;
+
+        std::vector<preload_result> preloaded;
+    };
+
     class vm_object {
         JavaVM *jvm;
         std::optional<jvmti_object> jvmti;
         JNIEnv *jni;
 
         int version;
+
+        startup_report report;
     public:
         vm_object(const int version, JavaVM *jvm, jvmtiEnv *jvmti_env, JNIEnv *jni):
             version(version),
@@ -32,6 +69,8 @@ namespace znb_kit
             if (jvmti_env != nullptr) {
                 jvmti.emplace(jni, jvmti_env);
             }
+
+            thread_env::set_vm(jvm, version);
         }
 
         vm_object(const vm_object &) = delete;
@@ -41,7 +80,8 @@ namespace znb_kit
             jvm(std::exchange(other.jvm, nullptr)),
             jvmti(std::move(other.jvmti)),
             jni(std::exchange(other.jni, nullptr)),
-            version(other.version)
+            version(other.version),
+            report(std::move(other.report))
         {
         }
 
@@ -51,6 +91,8 @@ namespace znb_kit
             {
                 if (jvm != nullptr)
                 {
+                    thread_env::set_vm(nullptr, version);
+
                     jvm->DestroyJavaVM();
                 }
 
@@ -58,6 +100,12 @@ namespace znb_kit
                 jvm = std::exchange(other.jvm, nullptr);
                 jni = std::exchange(other.jni, nullptr);
                 jvmti = std::move(other.jvmti);
+                report = std::move(other.report);
+
+                if (jvm != nullptr)
+                {
+                    thread_env::set_vm(jvm, version);
+                }
             }
 
             return *this;
@@ -80,10 +128,47 @@ namespace znb_kit
 
         [[nodiscard]] JNIEnv *get_env() const;
 
+        /*
+         * Gives up ownership of the JavaVM; the destructor will no longer call DestroyJavaVM.
+         */
+        JavaVM *release()
+        {
+            jni = nullptr;
+            jvmti.reset();
+
+            thread_env::set_vm(nullptr, version);
+
+            return std::exchange(jvm, nullptr);
+        }
+
+        [[nodiscard]] const startup_report &get_startup_report() const
+        {
+            return report;
+        }
+
+        void set_startup_report(const startup_report &new_report)
+        {
+            report = new_report;
+        }
+
+        /*
+         * Records the time from VM creation to the first useful call. Only the first invocation is kept.
+         */
+        void mark_first_call();
+
+        /*
+         * Startup phases recorded so far (VM creation, JVMTI setup, class resolution, mapping and registration).
+         */
+        [[nodiscard]] std::vector<timeline_phase> get_timeline() const;
+
+        [[nodiscard]] std::string get_timeline_json() const;
+
         ~vm_object()
         {
             if (jvm != nullptr)
             {
+                thread_env::set_vm(nullptr, version);
+
                 jvm->DestroyJavaVM();
                 jvm = nullptr;
             }
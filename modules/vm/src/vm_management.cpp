@@ -4,7 +4,20 @@
 
 #include "ZNBKit/vm/vm_management.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <set>
+#include <thread>
+
 #include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/local_ref.hpp"
+#include "ZNBKit/internal/timeline.hpp"
+#include "ZNBKit/internal/util.hpp"
+
+std::mutex znb_kit::vm_management::shutdown_hooks_mutex;
+std::vector<znb_kit::vm_management::shutdown_hook> znb_kit::vm_management::shutdown_hooks;
 
 std::unique_ptr<znb_kit::vm_object> znb_kit::vm_management::create_and_wrap_vm(const std::string &classpath)
 {
@@ -24,7 +37,26 @@ std::unique_ptr<znb_kit::vm_object> znb_kit::vm_management::create_and_wrap_vm(c
                                                              const std::optional<jvmti_data> jvmti_data)
 {
     debug_print_ignore_formatting("[VM] Initializing Java Virtual Machine..."); //messages generated by AI, cuz i ain't writing them myself
-    const auto [jvm, jni] = create_vm(vm_data);
+
+    startup_report report;
+    std::vector<std::string> extra_options;
+
+    if (vm_data.cds.has_value())
+    {
+        timeline::scope phase("cds_prepare");
+        const auto cds = prepare_cds(vm_data.cds.value(), vm_data, extra_options);
+
+        report.cds = cds.cds;
+        report.archive = cds.archive;
+    }
+
+    const auto [jvm, jni] = create_vm(vm_data, extra_options);
+
+    if (report.cds != startup_report::DISABLED)
+    {
+        timeline::scope phase("cds_verify", report.archive.string());
+        verify_cds(jni, report);
+    }
 
     jvmtiEnv *jvmti = nullptr;
     debug_print_ignore_formatting("[VM] ═══════════════════════════════════");
@@ -39,10 +71,24 @@ std::unique_ptr<znb_kit::vm_object> znb_kit::vm_management::create_and_wrap_vm(c
         debug_print_ignore_formatting("[VM] JVMTI initialization omitted - optional features unavailable");
     }
 
-    debug_print_ignore_formatting("[VM] Java Virtual Machine initialization complete");
+    if (vm_data.preload.has_value())
+    {
+        report.preloaded = preload_classes(jvm, vm_data.version, vm_data.preload.value());
+    }
+
+    const auto finished_at = std::chrono::steady_clock::now();
+
+    report.startup = finished_at - report.started_at;
+    timeline::record("startup", "", report.started_at, finished_at);
+
+    debug_print_ignore_formatting(std::format("[VM] Java Virtual Machine initialization complete in {} us",
+        std::chrono::duration_cast<std::chrono::microseconds>(report.startup).count()));
     debug_print_ignore_formatting("[VM] ═══════════════════════════════════");
 
-    return std::make_unique<vm_object>(vm_data.version, jvm, jvmti, jni);
+    auto vm = std::make_unique<vm_object>(vm_data.version, jvm, jvmti, jni);
+    vm->set_startup_report(report);
+
+    return vm;
 }
 
 std::unique_ptr<znb_kit::vm_object> znb_kit::vm_management::wrap_vm(JavaVM *jvm, const std::optional<jvmti_data> jvmti_data)
@@ -78,6 +124,387 @@ void znb_kit::vm_management::cleanup_vm(JavaVM *vm)
     }
 }
 
+void znb_kit::vm_management::add_shutdown_hook(const std::string &name, const std::function<void()> &hook,
+                                               const std::optional<std::chrono::milliseconds> deadline)
+{
+    if (!hook)
+    {
+        throw std::invalid_argument("Shutdown hook '" + name + "' is empty.");
+    }
+
+    std::lock_guard lock(shutdown_hooks_mutex);
+    shutdown_hooks.push_back({name, hook, deadline});
+}
+
+znb_kit::vm_management::shutdown_report znb_kit::vm_management::shutdown_vm(std::unique_ptr<vm_object> vm, const shutdown_data &shutdown_data)
+{
+    if (vm == nullptr || vm->get_owner() == nullptr)
+    {
+        throw std::invalid_argument("vm is null.");
+    }
+
+    const auto started_at = std::chrono::steady_clock::now();
+
+    shutdown_report report;
+    report.mode = shutdown_data.mode;
+
+    std::vector<shutdown_hook> hooks;
+    {
+        std::lock_guard lock(shutdown_hooks_mutex);
+        hooks = std::move(shutdown_hooks);
+        shutdown_hooks.clear();
+    }
+
+    for (const auto &[name, hook, deadline] : hooks)
+    {
+        /*
+         * The promise is shared with the thread, so an abandoned hook can still finish (or not) without touching freed state.
+         */
+        auto done = std::make_shared<std::promise<void>>();
+        auto future = done->get_future();
+
+        std::thread([hook, done, name] {
+            try
+            {
+                hook();
+            }
+            catch (const std::exception &e)
+            {
+                debug_print_cerr("[VM] Shutdown hook '" + name + "' failed: " + e.what());
+            }
+
+            done->set_value();
+        }).detach();
+
+        if (future.wait_for(deadline.value_or(shutdown_data.hook_deadline)) == std::future_status::ready)
+        {
+            ++report.hooks_run;
+        }
+        else
+        {
+            ++report.hooks_timed_out;
+            report.skipped.push_back("hook '" + name + "' (deadline exceeded)");
+        }
+    }
+
+    JNIEnv *jni = vm->get_env();
+
+    report.natives_unregistered = wrapper::unregister_all_natives(jni);
+
+    if (shutdown_data.mode == shutdown_data::FAST)
+    {
+        const size_t references = global_tracker::count() + local_refs.size();
+
+        report.skipped.push_back(std::format("deletion of {} tracked references", references));
+        report.skipped.emplace_back("DestroyJavaVM");
+
+        JavaVM *jvm = vm->release();
+        jvm->DetachCurrentThread();
+    }
+    else
+    {
+        report.references_deleted = global_tracker::count();
+
+        wrapper::cleanup_all_refs(jni);
+        wrapper::check_for_corruption();
+
+        /*
+         * DestroyJavaVM waits until the calling thread is the last non-daemon thread, so this thread has to detach
+         * before a helper thread can destroy the VM on its behalf.
+         */
+        JavaVM *jvm = vm->release();
+        jvm->DetachCurrentThread();
+
+        auto destroyed = std::make_shared<std::promise<jint>>();
+        auto future = destroyed->get_future();
+
+        std::thread([jvm, destroyed] {
+            destroyed->set_value(jvm->DestroyJavaVM());
+        }).detach();
+
+        if (future.wait_for(shutdown_data.timeout) == std::future_status::ready)
+        {
+            report.destroyed = future.get() == JNI_OK;
+        }
+        else
+        {
+            report.timed_out = true;
+            report.skipped.emplace_back("DestroyJavaVM (timed out waiting for non-daemon threads)");
+        }
+    }
+
+    report.duration = std::chrono::steady_clock::now() - started_at;
+
+    debug_print_ignore_formatting(std::format("[VM] {} shutdown finished in {} us, {} hooks run, {} natives unregistered, {} steps skipped",
+        shutdown_data.mode == shutdown_data::FAST ? "Fast" : "Graceful",
+        std::chrono::duration_cast<std::chrono::microseconds>(report.duration).count(),
+        report.hooks_run, report.natives_unregistered, report.skipped.size()));
+
+    return report;
+}
+
+std::vector<znb_kit::preload_result> znb_kit::vm_management::preload_classes(JavaVM *vm, const int version, const preload_data &preload_data)
+{
+    if (vm == nullptr)
+    {
+        throw std::invalid_argument("JavaVM is null.");
+    }
+
+    std::vector<std::string> names = preload_data.classes;
+
+    if (preload_data.manifest.has_value())
+    {
+        if (std::ifstream in(preload_data.manifest.value()); in)
+        {
+            for (std::string line; std::getline(in, line);)
+            {
+                std::erase_if(line, [](const unsigned char c) { return std::isspace(c); });
+
+                if (!line.empty() && !line.starts_with('#'))
+                {
+                    names.push_back(line);
+                }
+            }
+        }
+        else
+        {
+            debug_print_cerr("[VM] Unable to read preload manifest: " + preload_data.manifest->string());
+        }
+    }
+
+    for (auto &name : names)
+    {
+        std::ranges::replace(name, '/', '.');
+    }
+
+    std::vector<preload_result> results(names.size());
+
+    if (names.empty())
+    {
+        return results;
+    }
+
+    timeline::scope phase("preload_classes");
+
+    const size_t thread_count = std::clamp<size_t>(preload_data.threads, 1, names.size());
+    std::atomic_size_t next = 0;
+
+    /*
+     * Class.forName(name, true, system loader) rather than FindClass, so static initializers run here and not on
+     * the first request. Exceptions are expected for missing or broken classes and are reported, not printed.
+     */
+    const auto worker = [&](const size_t index) {
+        JNIEnv *jni = nullptr;
+        std::string thread_name = std::format("znb-preload-{}", index);
+
+        JavaVMAttachArgs attach_args;
+        attach_args.version = version;
+        attach_args.name = thread_name.data();
+        attach_args.group = nullptr;
+
+        if (vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void **>(&jni), &attach_args) != JNI_OK)
+        {
+            debug_print_cerr("[VM] Unable to attach preload thread " + thread_name);
+            return;
+        }
+
+        const auto class_klass = jni->FindClass("java/lang/Class");
+        const auto loader_klass = jni->FindClass("java/lang/ClassLoader");
+        const auto throwable_klass = jni->FindClass("java/lang/Throwable");
+
+        const auto for_name = jni->GetStaticMethodID(class_klass, "forName", "(Ljava/lang/String;ZLjava/lang/ClassLoader;)Ljava/lang/Class;");
+        const auto get_system_loader = jni->GetStaticMethodID(loader_klass, "getSystemClassLoader", "()Ljava/lang/ClassLoader;");
+        const auto to_string = jni->GetMethodID(throwable_klass, "toString", "()Ljava/lang/String;");
+
+        const auto loader = for_name != nullptr && get_system_loader != nullptr && to_string != nullptr
+            ? jni->CallStaticObjectMethodA(loader_klass, get_system_loader, nullptr)
+            : nullptr;
+
+        if (jni->ExceptionCheck() || loader == nullptr)
+        {
+            jni->ExceptionClear();
+            debug_print_cerr("[VM] Unable to resolve class loading methods on preload thread " + thread_name);
+
+            vm->DetachCurrentThread();
+            return;
+        }
+
+        for (size_t i = next++; i < names.size(); i = next++)
+        {
+            auto &result = results[i];
+            result.name = names[i];
+
+            const auto begin = std::chrono::steady_clock::now();
+
+            try
+            {
+                const auto name = jni->NewStringUTF(names[i].c_str());
+
+                jvalue parameters[3];
+                parameters[0].l = name;
+                parameters[1].z = JNI_TRUE;
+                parameters[2].l = loader;
+
+                const auto klass = jni->CallStaticObjectMethodA(class_klass, for_name, parameters);
+
+                if (const auto throwable = jni->ExceptionOccurred())
+                {
+                    jni->ExceptionClear();
+
+                    const auto description = reinterpret_cast<jstring>(jni->CallObjectMethodA(throwable, to_string, nullptr));
+                    jni->ExceptionClear();
+
+                    result.error = description != nullptr ? get_string(jni, description) : "unknown exception";
+
+                    jni->DeleteLocalRef(description);
+                    jni->DeleteLocalRef(throwable);
+                }
+                else
+                {
+                    result.loaded = true;
+                }
+
+                jni->DeleteLocalRef(klass);
+                jni->DeleteLocalRef(name);
+            }
+            catch (const std::exception &e)
+            {
+                result.error = e.what();
+            }
+
+            const auto end = std::chrono::steady_clock::now();
+
+            result.duration = end - begin;
+            timeline::record("preload", result.name, begin, end);
+        }
+
+        jni->DeleteLocalRef(loader);
+        jni->DeleteLocalRef(throwable_klass);
+        jni->DeleteLocalRef(loader_klass);
+        jni->DeleteLocalRef(class_klass);
+
+        vm->DetachCurrentThread();
+    };
+
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+
+        for (size_t i = 0; i < thread_count; ++i)
+        {
+            threads.emplace_back(worker, i);
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    size_t loaded = 0;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto &result = results[i];
+
+        if (result.name.empty())
+        {
+            result.name = names[i];
+            result.error = "no preload thread could be attached";
+        }
+
+        if (result.loaded)
+        {
+            ++loaded;
+        }
+        else
+        {
+            debug_print_cerr("[VM] Failed to preload " + result.name + ": " + result.error);
+        }
+    }
+
+    phase.set_count(loaded);
+
+    debug_print_ignore_formatting(std::format("[VM] Preloaded {} of {} classes on {} threads", loaded, results.size(), thread_count));
+
+    return results;
+}
+
+size_t znb_kit::vm_management::record_preload_manifest(const vm_object &vm, const std::filesystem::path &path)
+{
+    const auto jvmti_object = vm.get_jvmti();
+
+    if (!jvmti_object.has_value())
+    {
+        throw std::runtime_error("Recording a preload manifest requires JVMTI.");
+    }
+
+    jvmtiEnv *jvmti = jvmti_object->get().get_owner();
+    JNIEnv *jni = vm.get_env();
+
+    jint class_count = 0;
+    jclass *classes = nullptr;
+
+    if (jvmti->GetLoadedClasses(&class_count, &classes) != JVMTI_ERROR_NONE)
+    {
+        throw std::runtime_error("Failed to get loaded classes.");
+    }
+
+    std::set<std::string> names;
+
+    for (jint i = 0; i < class_count; ++i)
+    {
+        jobject loader = nullptr;
+        char *signature = nullptr;
+
+        if (jvmti->GetClassLoader(classes[i], &loader) == JVMTI_ERROR_NONE && loader != nullptr &&
+            jvmti->GetClassSignature(classes[i], &signature, nullptr) == JVMTI_ERROR_NONE && signature != nullptr)
+        {
+            std::string name = signature;
+
+            /*
+             * Arrays, primitives and hidden classes (lambdas, generated proxies) cannot be loaded by name.
+             */
+            if (name.size() > 2 && name.starts_with('L') && name.ends_with(';') &&
+                name.find("0x") == std::string::npos && name.find("$$Lambda") == std::string::npos)
+            {
+                name = name.substr(1, name.size() - 2);
+                std::ranges::replace(name, '/', '.');
+
+                names.insert(name);
+            }
+        }
+
+        if (signature != nullptr)
+        {
+            jvmti->Deallocate(reinterpret_cast<unsigned char *>(signature));
+        }
+
+        jni->DeleteLocalRef(loader);
+        jni->DeleteLocalRef(classes[i]);
+    }
+
+    jvmti->Deallocate(reinterpret_cast<unsigned char *>(classes));
+
+    std::ofstream out(path, std::ios::trunc);
+
+    if (!out)
+    {
+        throw std::runtime_error("Unable to write preload manifest: " + path.string());
+    }
+
+    out << "# znb preload manifest\n";
+
+    for (const auto &name : names)
+    {
+        out << name << '\n';
+    }
+
+    debug_print_ignore_formatting(std::format("[VM] Recorded {} classes to preload manifest {}", names.size(), path.string()));
+
+    return names.size();
+}
+
 jvmtiCapabilities znb_kit::vm_management::get_capabilities(const jvmtiEnv *jvmti, const jvmti_data data)
 {
     if (jvmti == nullptr)
@@ -88,22 +515,25 @@ jvmtiCapabilities znb_kit::vm_management::get_capabilities(const jvmtiEnv *jvmti
     jvmtiCapabilities capabilities = {};
     capabilities.can_get_bytecodes = data.capabilities.can_get_bytecodes;
     capabilities.can_generate_all_class_hook_events = data.capabilities.can_get_bytecodes;
+    capabilities.can_generate_compiled_method_load_events = data.capabilities.can_observe_compilation;
+    capabilities.can_generate_sampled_object_alloc_events = data.capabilities.can_sample_allocations;
+    capabilities.can_tag_objects = data.capabilities.can_tag_objects;
+    capabilities.can_generate_garbage_collection_events = data.capabilities.can_observe_gc;
+    capabilities.can_generate_object_free_events = data.capabilities.can_observe_object_free;
 
     return capabilities;
 }
 
-std::pair<JavaVM *, JNIEnv *> znb_kit::vm_management::create_vm(const vm_data &vm_data)
+std::pair<JavaVM *, JNIEnv *> znb_kit::vm_management::create_vm(const vm_data &vm_data, const std::vector<std::string> &extra_options)
 {
-    const bool use_classpath = vm_data.classpath.has_value();
-    const int options_count = use_classpath ? 1 : 0;
+    timeline::scope phase("create_vm");
 
     JavaVM *jvm;
     JavaVMInitArgs vm_args;
-    JavaVMOption options[options_count];
 
-    std::string classpath_option;
+    std::vector<std::string> option_strings;
 
-    if (use_classpath)
+    if (vm_data.classpath.has_value())
     {
         debug_print_ignore_formatting("[VM] ═══════════════════════════════════");
         debug_print_ignore_formatting("[VM] Configuring classpath for file-based class loading");
@@ -115,16 +545,25 @@ std::pair<JavaVM *, JNIEnv *> znb_kit::vm_management::create_vm(const vm_data &v
             throw std::invalid_argument("Unable to determine classpath. [" + classpath + "]");
         }
 
-        classpath_option = "-Djava.class.path=" + classpath;
-
-        options[0].optionString = const_cast<char *>(classpath_option.c_str());
+        option_strings.push_back("-Djava.class.path=" + classpath);
 
         debug_print_ignore_formatting("[VM] Classpath configured: " + classpath);
     }
 
+    option_strings.insert(option_strings.end(), vm_data.options.begin(), vm_data.options.end());
+    option_strings.insert(option_strings.end(), extra_options.begin(), extra_options.end());
+
+    std::vector<JavaVMOption> options(option_strings.size());
+
+    for (size_t i = 0; i < option_strings.size(); ++i)
+    {
+        options[i].optionString = const_cast<char *>(option_strings[i].c_str());
+        options[i].extraInfo = nullptr;
+    }
+
     vm_args.version = vm_data.version;
-    vm_args.nOptions = options_count;
-    vm_args.options = options;
+    vm_args.nOptions = static_cast<jint>(options.size());
+    vm_args.options = options.data();
 
     vm_args.ignoreUnrecognized = JNI_FALSE;
 
@@ -138,6 +577,142 @@ std::pair<JavaVM *, JNIEnv *> znb_kit::vm_management::create_vm(const vm_data &v
     return std::make_pair(jvm, jni);
 }
 
+znb_kit::startup_report znb_kit::vm_management::prepare_cds(const cds_data &cds_data, const vm_data &vm_data, std::vector<std::string> &options)
+{
+    startup_report report;
+    const auto &classpath = vm_data.classpath;
+
+    if (!classpath.has_value() || classpath->empty())
+    {
+        debug_print_ignore_formatting("[VM] CDS requested without a classpath, skipping archive");
+        return report;
+    }
+
+    /*
+     * FNV-1a over every classpath entry and its size and modification time. Cheap enough to run on every start
+     * and sufficient to tell a rebuilt jar apart from the one that was archived. The entry paths and the VM options
+     * identify the configuration and pick the subdirectory, so processes configured differently never see (or sweep)
+     * this archive.
+     */
+    uint64_t identity = 0xcbf29ce484222325ULL;
+    uint64_t key = 0xcbf29ce484222325ULL;
+
+    const auto mix = [](uint64_t &hash, const std::string &value) {
+        for (const unsigned char c : value)
+        {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+
+    size_t begin = 0;
+
+    while (begin <= classpath->size())
+    {
+        const size_t end = std::min(classpath->find(':', begin), classpath->size());
+        const std::filesystem::path entry = classpath->substr(begin, end - begin);
+
+        begin = end + 1;
+
+        if (entry.empty())
+        {
+            continue;
+        }
+
+        std::error_code error;
+
+        const auto absolute = std::filesystem::absolute(entry, error).string();
+
+        mix(identity, absolute);
+        mix(key, absolute);
+        mix(key, std::to_string(std::filesystem::file_size(entry, error)));
+        mix(key, std::to_string(std::filesystem::last_write_time(entry, error).time_since_epoch().count()));
+    }
+
+    for (const auto &option : vm_data.options)
+    {
+        mix(identity, option + '\n');
+        mix(key, option + '\n');
+    }
+
+    const auto directory = cds_data.directory / std::format("{}-{:016x}", cds_data.name, identity);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    if (error)
+    {
+        debug_print_ignore_formatting("[VM] Unable to create CDS directory: " + error.message());
+        return report;
+    }
+
+    report.archive = directory / std::format("{:016x}.jsa", key);
+
+    auto version_path = report.archive;
+    version_path += ".version";
+
+    /*
+     * Everything else in the subdirectory was archived from an older build of the same classpath.
+     */
+    for (const auto &file : std::filesystem::directory_iterator(directory, error))
+    {
+        const auto file_name = file.path().filename().string();
+
+        if (file.path() != report.archive && file.path() != version_path && (file_name.ends_with(".jsa") || file_name.ends_with(".jsa.version")))
+        {
+            debug_print_ignore_formatting("[VM] Removing stale CDS archive: " + file.path().string());
+            std::filesystem::remove(file.path(), error);
+        }
+    }
+
+    report.cds = std::filesystem::exists(report.archive) ? startup_report::REUSE : startup_report::TRAINING;
+
+    options.emplace_back("-XX:+AutoCreateSharedArchive");
+    options.emplace_back("-XX:SharedArchiveFile=" + report.archive.string());
+
+    debug_print_ignore_formatting(std::format("[VM] CDS archive {} ({})", report.archive.string(),
+        report.cds == startup_report::REUSE ? "reuse" : "training run, dumped at exit"));
+
+    return report;
+}
+
+void znb_kit::vm_management::verify_cds(JNIEnv *jni, startup_report &report)
+{
+    /*
+     * The archive stores the JVM version next to it. If it differs from the running one, the VM has rejected the
+     * archive and will regenerate it at exit, so this start is effectively another training run.
+     */
+    const local_class klass(jni, wrapper::search_for_class(jni, "java/lang/System"));
+    const auto method = wrapper::get_method(jni, klass.get(), "getProperty", "(Ljava/lang/String;)Ljava/lang/String;", true);
+
+    const local_string key(jni, jni->NewStringUTF("java.vm.version"));
+    const std::vector<jvalue> parameters = {{.l = key.get()}};
+
+    const auto value = invoke_object<jstring>(jni, klass.get(), nullptr, method, parameters);
+    const auto version = value ? get_string(jni, value.get()) : std::string{};
+
+    auto version_path = report.archive;
+    version_path += ".version";
+
+    std::string archived_version;
+
+    if (std::ifstream in(version_path); in)
+    {
+        std::getline(in, archived_version);
+    }
+
+    if (report.cds == startup_report::REUSE && archived_version != version)
+    {
+        debug_print_ignore_formatting("[VM] CDS archive was created by a different JVM (" + archived_version + "), regenerating at exit");
+        report.cds = startup_report::TRAINING;
+    }
+
+    if (std::ofstream out(version_path, std::ios::trunc); out)
+    {
+        out << version << '\n';
+    }
+}
+
 jvmtiEnv * znb_kit::vm_management::get_jvmti(JavaVM *vm, const int version)
 {
     jvmtiEnv *jvmti = nullptr;
@@ -162,15 +737,22 @@ jvmtiEnv * znb_kit::vm_management::get_jvmti(JavaVM *vm, const jvmti_data data)
 
     debug_print_ignore_formatting("[VM] Requesting JVMTI environment (version: " + version_str + ")");
 
-    jvmti = get_jvmti(vm, data.version);
+    {
+        timeline::scope phase("get_jvmti", version_str);
+        jvmti = get_jvmti(vm, data.version);
+    }
 
     const auto capabilities = get_capabilities(jvmti, data);
 
     debug_print_ignore_formatting("[VM] Requesting JVMTI capabilities");
 
-    if (jvmti->AddCapabilities(&capabilities) != JVMTI_ERROR_NONE)
     {
-        throw std::runtime_error("Failed to add jvmti capabilities.");
+        timeline::scope phase("add_capabilities");
+
+        if (jvmti->AddCapabilities(&capabilities) != JVMTI_ERROR_NONE)
+        {
+            throw std::runtime_error("Failed to add jvmti capabilities.");
+        }
     }
 
     debug_print_ignore_formatting("[VM] JVMTI capabilities successfully applied");
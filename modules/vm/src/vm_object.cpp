@@ -4,6 +4,11 @@
 
 #include "ZNBKit/vm/vm_object.hpp"
 
+#include <format>
+
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/timeline.hpp"
+
 JNIEnv *znb_kit::vm_object::get_env() const
 {
     JNIEnv *env = nullptr;
@@ -24,3 +29,31 @@ JNIEnv *znb_kit::vm_object::get_env() const
 
     return env;
 }
+
+void znb_kit::vm_object::mark_first_call()
+{
+    if (report.first_call.has_value())
+    {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    report.first_call = now - report.started_at;
+    timeline::record("first_call", "", report.started_at, now);
+
+    debug_print_ignore_formatting(std::format("[VM] First call after {} us (startup {} us, cds: {})",
+        std::chrono::duration_cast<std::chrono::microseconds>(report.first_call.value()).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(report.startup).count(),
+        report.cds == startup_report::REUSE ? "reuse" : report.cds == startup_report::TRAINING ? "training" : "disabled"));
+}
+
+std::vector<znb_kit::timeline_phase> znb_kit::vm_object::get_timeline() const
+{
+    return timeline::snapshot();
+}
+
+std::string znb_kit::vm_object::get_timeline_json() const
+{
+    return timeline::to_json();
+}
@@ -0,0 +1,408 @@
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <thread>
+
+#include "ZNBKit/setup.hpp"
+#include "ZNBKit/jni/column_batch.hpp"
+#include "ZNBKit/jni/flat_record.hpp"
+#include "ZNBKit/jni/mapped_file.hpp"
+#include "ZNBKit/jni/shared_ring.hpp"
+#include "ZNBKit/jni/slab_allocator.hpp"
+
+using namespace znb_kit;
+
+struct flat_event
+{
+    jlong id;
+    jint kind;
+    std::string name;
+    std::vector<jint> samples;
+    jdouble value;
+};
+
+TEST_CASE("flat record marshaling", "[jni]")
+{
+    const auto schema = make_flat_schema<flat_event>(
+        flat_field<&flat_event::id>{"id"},
+        flat_field<&flat_event::kind>{"kind"},
+        flat_field<&flat_event::name>{"name"},
+        flat_field<&flat_event::samples>{"samples"},
+        flat_field<&flat_event::value>{"value"});
+
+    const std::vector<flat_event> events = {
+        {1, 2, "bridge", {3, 4, 5}, 0.5},
+        {6, 7, "", {}, -1.0},
+    };
+
+    SECTION("Round trip through a byte[]") {
+        const auto jni = vm->get_env();
+        const auto array = schema.to_byte_array(jni, std::span<const flat_event>(events));
+
+        REQUIRE(static_cast<size_t>(jni->GetArrayLength(array)) == schema.encoded_size(std::span<const flat_event>(events)));
+
+        const auto decoded = schema.from_byte_array(jni, array);
+
+        REQUIRE(decoded.size() == 2);
+        REQUIRE(decoded[0].name == "bridge");
+        REQUIRE(decoded[0].samples == std::vector<jint>{3, 4, 5});
+        REQUIRE(decoded[1].id == 6);
+        REQUIRE(decoded[1].value == -1.0);
+
+        jni->DeleteLocalRef(array);
+    }
+
+    SECTION("Layout description") {
+        REQUIRE(schema.describe().find("\"name\":\"samples\",\"type\":\"int[]\"") != std::string::npos);
+    }
+}
+
+TEST_CASE("columnar batch exchange", "[jni]")
+{
+    column_batch batch({{"id", INT64, false}, {"score", FLOAT64}, {"name", UTF8}});
+
+    for (int64_t i = 0; i < 100; ++i)
+    {
+        batch.append(0, i);
+
+        if (i % 10 == 0)
+        {
+            batch.append_null(1);
+            batch.append_null(2);
+        }
+        else
+        {
+            batch.append(1, static_cast<double>(i) / 2);
+            batch.append(2, "row-" + std::to_string(i));
+        }
+    }
+
+    SECTION("Vectorized helpers") {
+        const auto scores = batch.view(1);
+
+        REQUIRE(batch.rows() == 100);
+        REQUIRE(scores.null_count() == 10);
+        REQUIRE(scores.min<double>() == 0.5);
+        REQUIRE(scores.max<double>() == 49.5);
+        REQUIRE(batch.view(0).max<int64_t>() == 99);
+        REQUIRE_THROWS_AS(scores.min<float>(), std::invalid_argument);
+    }
+
+    SECTION("Round trip through ByteBuffer views") {
+        const auto jni = vm->get_env();
+        const auto buffers = batch.to_java(jni);
+
+        REQUIRE(jni->GetArrayLength(buffers) == 9);
+
+        const column_batch_reader reader(jni, buffers, batch.get_schema(), batch.rows());
+
+        REQUIRE(reader.column(0).get_values<int64_t>()[42] == 42);
+        REQUIRE_FALSE(reader.column(2).is_valid(20));
+        REQUIRE(reader.column(2).get_string(21) == "row-21");
+
+        jni->DeleteLocalRef(buffers);
+    }
+
+    SECTION("Reader with mixed nullability") {
+        const auto jni = vm->get_env();
+        const auto buffers = batch.to_java(jni);
+
+        const column_batch_reader reader(jni, buffers, batch.get_schema(), batch.rows());
+
+        REQUIRE(reader.rows() == 100);
+        REQUIRE(reader.column(0).null_count() == 0);
+        REQUIRE(reader.column(0).is_valid(20));
+        REQUIRE(reader.column(1).null_count() == 10);
+        REQUIRE(reader.column(2).null_count() == 10);
+        REQUIRE(reader.column(1).max<double>() == 49.5);
+
+        auto nullable = batch.get_schema();
+        nullable[0].nullable = true;
+
+        const column_batch_reader all_valid(jni, buffers, nullable, batch.rows());
+        REQUIRE(all_valid.column(0).null_count() == 0);
+
+        auto strict = batch.get_schema();
+        strict[1].nullable = false;
+
+        REQUIRE_THROWS_AS(column_batch_reader(jni, buffers, strict, batch.rows()), std::invalid_argument);
+
+        jni->DeleteLocalRef(buffers);
+    }
+
+    SECTION("Non-nullable columns reject nulls") {
+        REQUIRE_THROWS_AS(batch.append_null(0), std::invalid_argument);
+    }
+}
+
+TEST_CASE("slab allocator slices", "[jni]")
+{
+    slab_allocator allocator({.thread_cache = 8});
+
+    SECTION("Size classes and explicit frees") {
+        const auto small = allocator.allocate(100);
+        const auto large = allocator.allocate(3 << 20);
+
+        REQUIRE(allocator.get(small.handle).size() == 128);
+        REQUIRE(allocator.get_stats().large_allocations == 1);
+
+        allocator.free(small.handle);
+
+        REQUIRE_THROWS_AS(allocator.free(small.handle), std::invalid_argument);
+        REQUIRE(allocator.free_bulk(std::vector<uint64_t>{large.handle, small.handle}) == 1);
+        REQUIRE(allocator.get_stats().in_use_bytes == 0);
+    }
+
+    SECTION("Direct buffers carry their handle") {
+        const auto jni = vm->get_env();
+        const auto view = allocator.allocate_java(jni, 4096);
+        const auto handle = allocator.handle_of(jni, view);
+
+        REQUIRE(jni->GetDirectBufferCapacity(view) == 4096);
+        REQUIRE(allocator.get(handle).data() == jni->GetDirectBufferAddress(view));
+
+        allocator.free(handle);
+        jni->DeleteLocalRef(view);
+    }
+}
+
+TEST_CASE("shared ring messaging", "[jni]")
+{
+    const auto bytes_of = [](const uint32_t &value) {
+        return std::as_bytes(std::span(&value, 1));
+    };
+
+    const auto value_of = [](const std::span<const std::byte> payload) {
+        uint32_t value = 0;
+        std::memcpy(&value, payload.data(), std::min(payload.size(), sizeof(value)));
+
+        return value;
+    };
+
+    SECTION("Records wrap around the end of the ring") {
+        shared_ring ring({.capacity = 4096});
+
+        std::vector<std::byte> payload(1000);
+        uint32_t written = 0;
+        uint32_t read = 0;
+
+        for (int round = 0; round < 40; ++round)
+        {
+            while (true)
+            {
+                std::memcpy(payload.data(), &written, sizeof(written));
+
+                if (!ring.try_write(7, payload))
+                {
+                    break;
+                }
+
+                ++written;
+            }
+
+            ring.read([&](const int32_t type, const std::span<const std::byte> message) {
+                REQUIRE(type == 7);
+                REQUIRE(message.size() == payload.size());
+                REQUIRE(value_of(message) == read++);
+            });
+        }
+
+        REQUIRE(read == written);
+        REQUIRE(ring.size() == 0);
+        REQUIRE(written > 4096 / 1008 * 2);
+    }
+
+    SECTION("Multiple producers keep their own order") {
+        shared_ring ring({.capacity = 1 << 16, .producers = shared_ring::MULTI_PRODUCER});
+
+        constexpr int32_t producer_count = 4;
+        constexpr uint32_t per_producer = 20000;
+
+        std::vector<std::thread> producers;
+
+        for (int32_t producer = 0; producer < producer_count; ++producer)
+        {
+            producers.emplace_back([&ring, &bytes_of, producer] {
+                for (uint32_t i = 0; i < per_producer; ++i)
+                {
+                    while (!ring.try_write(producer, bytes_of(i)))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<uint32_t> next(producer_count, 0);
+        uint32_t total = 0;
+
+        while (total < producer_count * per_producer)
+        {
+            total += static_cast<uint32_t>(ring.read([&](const int32_t type, const std::span<const std::byte> message) {
+                REQUIRE(value_of(message) == next[type]++);
+            }));
+        }
+
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+
+        REQUIRE(std::ranges::all_of(next, [](const uint32_t count) { return count == per_producer; }));
+    }
+
+    SECTION("Batches are written whole or not at all") {
+        shared_ring ring({.capacity = 4096});
+
+        const std::vector<std::byte> large(2000);
+        REQUIRE(ring.try_write(1, large));
+
+        const uint32_t values[] = {10, 11, 12};
+        const std::vector<std::span<const std::byte>> fitting = {bytes_of(values[0]), bytes_of(values[1]), bytes_of(values[2])};
+        const std::vector<std::span<const std::byte>> too_large = {std::span<const std::byte>(large), std::span<const std::byte>(large)};
+
+        const size_t before = ring.size();
+
+        REQUIRE_FALSE(ring.try_write_batch(2, too_large));
+        REQUIRE(ring.size() == before);
+        REQUIRE(ring.get_rejected() == too_large.size());
+
+        REQUIRE(ring.try_write_batch(3, fitting));
+
+        std::vector<std::pair<int32_t, uint32_t>> received;
+
+        ring.read([&](const int32_t type, const std::span<const std::byte> message) {
+            received.emplace_back(type, value_of(message));
+        });
+
+        REQUIRE(received.size() == 4);
+        REQUIRE(received[0].first == 1);
+        REQUIRE(received[1] == std::pair<int32_t, uint32_t>{3, 10});
+        REQUIRE(received[3] == std::pair<int32_t, uint32_t>{3, 12});
+    }
+
+    SECTION("Java view matches the documented layout") {
+        const auto jni = vm->get_env();
+
+        shared_ring ring({.capacity = 4096, .producers = shared_ring::MULTI_PRODUCER});
+        REQUIRE(ring.try_write(5, bytes_of(42)));
+
+        const auto view = ring.to_java(jni);
+        const auto *base = static_cast<const std::byte *>(jni->GetDirectBufferAddress(view));
+
+        REQUIRE(jni->GetDirectBufferCapacity(view) == static_cast<jlong>(shared_ring::HEADER_SIZE + ring.get_capacity()));
+
+        uint32_t magic, version, producers;
+        uint64_t capacity, tail, head;
+
+        std::memcpy(&magic, base, sizeof(magic));
+        std::memcpy(&version, base + 4, sizeof(version));
+        std::memcpy(&capacity, base + 8, sizeof(capacity));
+        std::memcpy(&producers, base + 16, sizeof(producers));
+        std::memcpy(&tail, base + shared_ring::TAIL_OFFSET, sizeof(tail));
+        std::memcpy(&head, base + shared_ring::HEAD_OFFSET, sizeof(head));
+
+        REQUIRE(magic == shared_ring::MAGIC);
+        REQUIRE(version == shared_ring::VERSION);
+        REQUIRE(capacity == ring.get_capacity());
+        REQUIRE(producers == shared_ring::MULTI_PRODUCER);
+        REQUIRE(tail == 16);
+        REQUIRE(head == 0);
+
+        int32_t length, type;
+
+        std::memcpy(&length, base + shared_ring::HEADER_SIZE, sizeof(length));
+        std::memcpy(&type, base + shared_ring::HEADER_SIZE + 4, sizeof(type));
+
+        REQUIRE(length == 12);
+        REQUIRE(type == 5);
+        REQUIRE(ring.describe().find("\"tail_offset\":128") != std::string::npos);
+
+        jni->DeleteLocalRef(view);
+    }
+}
+
+TEST_CASE("memory-mapped windows", "[jni]")
+{
+    const auto jni = vm->get_env();
+    const auto path = std::filesystem::temp_directory_path() / "znb-mapped-file-test.bin";
+
+    const auto get = wrapper::get_method(jni, "java/nio/ByteBuffer", "get", "(I)B", false);
+    const auto is_read_only = wrapper::get_method(jni, "java/nio/ByteBuffer", "isReadOnly", "()Z", false);
+
+    {
+        const auto file = mapped_file::open(path, {.access = mapped_file::READ_WRITE, .size = 8192});
+
+        for (size_t i = 0; i < file->size(); ++i)
+        {
+            file->get_data()[i] = static_cast<std::byte>(i % 251);
+        }
+
+        file->sync();
+    }
+
+    SECTION("Native writes are visible through the window") {
+        const auto file = mapped_file::open(path, {.access = mapped_file::READ_WRITE});
+        const auto window = file->window(jni, 4096, 1024);
+
+        REQUIRE(jni->GetDirectBufferCapacity(window) == 1024);
+        REQUIRE(jni->CallByteMethod(window, get, 10) == static_cast<jbyte>((4096 + 10) % 251));
+
+        file->get_data()[4096 + 10] = std::byte{0x7f};
+
+        REQUIRE(jni->CallByteMethod(window, get, 10) == 0x7f);
+        REQUIRE(mapped_file::release(jni, window));
+        REQUIRE_FALSE(mapped_file::release(jni, window));
+        REQUIRE(file->get_windows() == 0);
+
+        jni->DeleteLocalRef(window);
+    }
+
+    SECTION("Read-only mappings hand out read-only windows") {
+        const auto file = mapped_file::open(path);
+        const auto window = file->window(jni);
+
+        REQUIRE(jni->CallBooleanMethod(window, is_read_only));
+        REQUIRE(jni->CallByteMethod(window, get, 300) == static_cast<jbyte>(300 % 251));
+        REQUIRE_THROWS_AS(file->sync(), std::logic_error);
+
+        REQUIRE(mapped_file::release(jni, window));
+        jni->DeleteLocalRef(window);
+    }
+
+    SECTION("A window outlives the last native owner") {
+        auto file = mapped_file::open(path);
+        const auto window = file->window(jni, 100, 10);
+
+        const std::weak_ptr<mapped_file> observer = file;
+        file.reset();
+
+        REQUIRE_FALSE(observer.expired());
+        REQUIRE(jni->CallByteMethod(window, get, 0) == static_cast<jbyte>(100));
+
+        REQUIRE(mapped_file::release(jni, window));
+        REQUIRE(observer.expired());
+
+        jni->DeleteLocalRef(window);
+    }
+
+    SECTION("Collected windows are swept") {
+        auto file = mapped_file::open(path);
+        const std::weak_ptr<mapped_file> observer = file;
+
+        jni->DeleteLocalRef(file->window(jni));
+        file.reset();
+
+        REQUIRE_FALSE(observer.expired());
+
+        for (int attempt = 0; attempt < 10 && !observer.expired(); ++attempt)
+        {
+            vm->get_jvmti()->get().get_owner()->ForceGarbageCollection();
+            mapped_file::sweep(jni);
+        }
+
+        REQUIRE(observer.expired());
+    }
+
+    std::filesystem::remove(path);
+}
@@ -2,12 +2,26 @@
 // Created by Damian Netter on 11/05/2025.
 //
 
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <thread>
 
 #include "ZNBKit/setup.hpp"
 #include "ZNBKit/jni/instance.hpp"
+#include "ZNBKit/jni/signatures/method/int_method.hpp"
 #include "ZNBKit/jni/signatures/method/string_method.hpp"
 #include "ZNBKit/jni/signatures/method/void_method.hpp"
+#include "ZNBKit/jvmti/allocation_sampler.hpp"
+#include "ZNBKit/jvmti/class_transformer.hpp"
+#include "ZNBKit/jvmti/gc_telemetry.hpp"
+#include "ZNBKit/jvmti/heap_census.hpp"
+#include "ZNBKit/jvmti/jit_warmup.hpp"
+#include "ZNBKit/jvmti/jvmti_events.hpp"
+#include "ZNBKit/jvmti/jvmti_sampler.hpp"
+#include "ZNBKit/jvmti/object_tags.hpp"
+#include "ZNBKit/jvmti/perf_map_writer.hpp"
 
 /*
  * This test is designed to verify the functionality of dynamic method mapping in JVMTI.
@@ -70,3 +84,509 @@ TEST_CASE_METHOD(method_proxy_fixture, "JVMTI method mapping", "[jvmti]") {
         m_v.invoke(klass_instance.get_object(), parameters);
     }
 }
+
+TEST_CASE("object tags report every freed handle", "[jvmti]")
+{
+    const auto jni = vm->get_env();
+    const auto jvmti_env = vm->get_jvmti()->get().get_owner();
+
+    object_tags tags(jvmti_env);
+    tags.start();
+
+    /*
+     * More objects than a single ring holds, so a burst of frees has to spill over.
+     */
+    constexpr jlong count = 20000;
+
+    const auto klass = wrapper::search_for_class(jni, "java/lang/Object");
+    const auto constructor = wrapper::get_method(jni, klass, "<init>", "()V", false);
+
+    for (jlong handle = 1; handle <= count; ++handle)
+    {
+        const auto object = jni->NewObject(klass, constructor);
+
+        tags.associate(object, handle);
+        jni->DeleteLocalRef(object);
+    }
+
+    std::vector<bool> seen(count + 1, false);
+    jlong freed = 0;
+
+    for (int attempt = 0; attempt < 100 && freed < count; ++attempt)
+    {
+        jvmti_env->ForceGarbageCollection();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        tags.drain_freed([&](const std::span<const jlong> handles) {
+            for (const auto handle : handles)
+            {
+                REQUIRE(handle >= 1);
+                REQUIRE(handle <= count);
+                REQUIRE_FALSE(seen[handle]);
+
+                seen[handle] = true;
+                ++freed;
+            }
+        });
+    }
+
+    tags.stop();
+    wrapper::remove_local_ref(jni, klass);
+
+    REQUIRE(freed == count);
+    REQUIRE(tags.get_dropped() == 0);
+}
+
+TEST_CASE("sampler collects stacks across restarts", "[jvmti]")
+{
+    jvmti_sampler sampler(vm->get_owner(), vm->get_jvmti()->get().get_owner());
+
+    /*
+     * The JDK's own service threads are parked, so blocked threads have to be counted for samples to show up.
+     */
+    jvmti_sampler::options options;
+    options.interval = std::chrono::milliseconds(1);
+    options.runnable_only = false;
+
+    REQUIRE_THROWS_AS(sampler.start({std::chrono::microseconds(0)}), std::invalid_argument);
+    REQUIRE_FALSE(sampler.is_running());
+
+    for (int run = 0; run < 2; ++run)
+    {
+        sampler.reset();
+        sampler.start(options);
+        REQUIRE(sampler.is_running());
+
+        for (int attempt = 0; attempt < 100 && sampler.get_samples() == 0; ++attempt)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        sampler.stop();
+        REQUIRE_FALSE(sampler.is_running());
+
+        const size_t samples = sampler.get_samples();
+        REQUIRE(samples > 0);
+
+        size_t total = 0;
+
+        for (const auto &[stack, count] : sampler.snapshot())
+        {
+            REQUIRE_FALSE(stack.empty());
+            total += count;
+        }
+
+        REQUIRE(total == samples);
+
+        const auto collapsed = sampler.dump();
+        REQUIRE(collapsed.ends_with('\n'));
+        REQUIRE(collapsed.find(' ') != std::string::npos);
+    }
+}
+
+TEST_CASE("allocation sampler attributes sampled allocations", "[jvmti]")
+{
+    allocation_sampler sampler(vm->get_jvmti()->get().get_owner());
+
+    REQUIRE_THROWS_AS(sampler.start({-1}), std::invalid_argument);
+
+    allocation_sampler::options options;
+    options.interval = 0;
+
+    sampler.start(options);
+
+    const auto allocate = [](JNIEnv *jni) {
+        for (int i = 0; i < 128; ++i)
+        {
+            jni->DeleteLocalRef(jni->NewByteArray(4096));
+        }
+    };
+
+    allocate(vm->get_env());
+
+    /*
+     * A thread that attaches, allocates and detaches has its ring handed back on ThreadEnd.
+     */
+    std::thread([&allocate] {
+        JNIEnv *jni = nullptr;
+
+        if (vm->get_owner()->AttachCurrentThread(reinterpret_cast<void **>(&jni), nullptr) == JNI_OK)
+        {
+            allocate(jni);
+            vm->get_owner()->DetachCurrentThread();
+        }
+    }).join();
+
+    sampler.stop();
+
+    const auto sites = sampler.top_sites(16);
+    REQUIRE_FALSE(sites.empty());
+
+    const auto arrays = std::ranges::find(sites, "byte[]", &allocation_sampler::site::klass);
+    REQUIRE(arrays != sites.end());
+    REQUIRE(arrays->samples > 0);
+    REQUIRE(arrays->bytes >= static_cast<jlong>(arrays->samples) * 4096);
+
+    REQUIRE(std::ranges::is_sorted(sites, std::ranges::greater{}, &allocation_sampler::site::bytes));
+
+    sampler.reset();
+    REQUIRE(sampler.top_sites(16).empty());
+}
+
+TEST_CASE("heap census counts live instances", "[jvmti]")
+{
+    const auto jni = vm->get_env();
+    const auto jvmti_env = vm->get_jvmti()->get().get_owner();
+
+    heap_census census(jvmti_env);
+
+    constexpr jsize count = 1000;
+
+    const auto before = census.take(jni, true);
+
+    const auto object_klass = wrapper::search_for_class(jni, "java/lang/Object");
+    const auto klass = wrapper::search_for_class(jni, "java/util/concurrent/atomic/AtomicLong");
+    const auto constructor = wrapper::get_method(jni, klass, "<init>", "()V", false);
+
+    const auto holder = jni->NewObjectArray(count, object_klass, nullptr);
+
+    for (jsize i = 0; i < count; ++i)
+    {
+        const auto object = jni->NewObject(klass, constructor);
+
+        jni->SetObjectArrayElement(holder, i, object);
+        jni->DeleteLocalRef(object);
+    }
+
+    /*
+     * A tag set through the caller's environment has to survive the census' own class tagging.
+     */
+    REQUIRE(jvmti_env->SetTag(klass, 42) == JVMTI_ERROR_NONE);
+
+    const auto after = census.take(jni, true);
+
+    jlong tag = 0;
+    REQUIRE(jvmti_env->GetTag(klass, &tag) == JVMTI_ERROR_NONE);
+    REQUIRE(tag == 42);
+    REQUIRE(jvmti_env->SetTag(klass, 0) == JVMTI_ERROR_NONE);
+
+    REQUIRE(after.instances > 0);
+    REQUIRE(std::ranges::is_sorted(after.classes, std::ranges::greater{}, &heap_census::class_usage::bytes));
+
+    const auto differences = heap_census::diff(before, after);
+    const auto grown = std::ranges::find(differences, "java.util.concurrent.atomic.AtomicLong", &heap_census::difference::klass);
+
+    REQUIRE(grown != differences.end());
+    REQUIRE(grown->instances >= count);
+    REQUIRE(grown->bytes > 0);
+
+    REQUIRE(heap_census::to_json(differences).find("\"java.util.concurrent.atomic.AtomicLong\"") != std::string::npos);
+    REQUIRE(after.to_json().starts_with("{\"instances\":"));
+
+    jni->DeleteLocalRef(holder);
+    wrapper::remove_local_ref(jni, klass);
+    wrapper::remove_local_ref(jni, object_klass);
+}
+
+TEST_CASE("jvmti events reach subscribers off-thread", "[jvmti]")
+{
+    const auto jvmti_env = vm->get_jvmti()->get().get_owner();
+
+    jvmti_events events(jvmti_env);
+
+    jvmti_events::options options;
+    options.events = jvmti_event::mask(jvmti_event::GARBAGE_COLLECTION_START) |
+                     jvmti_event::mask(jvmti_event::GARBAGE_COLLECTION_FINISH) |
+                     jvmti_event::mask(jvmti_event::THREAD_START);
+
+    std::atomic_size_t collections_started{0};
+    std::atomic_size_t collections_finished{0};
+    std::atomic_size_t threads_started{0};
+    std::atomic_size_t unsubscribed_calls{0};
+
+    events.subscribe([&](const jvmti_event &event) {
+        if (event.type == jvmti_event::GARBAGE_COLLECTION_START)
+        {
+            ++collections_started;
+        }
+        else
+        {
+            ++collections_finished;
+        }
+    }, jvmti_event::mask(jvmti_event::GARBAGE_COLLECTION_START) | jvmti_event::mask(jvmti_event::GARBAGE_COLLECTION_FINISH));
+
+    events.subscribe([&](const jvmti_event &event) {
+        if (event.type == jvmti_event::THREAD_START)
+        {
+            ++threads_started;
+        }
+    }, jvmti_event::mask(jvmti_event::THREAD_START));
+
+    const size_t removed = events.subscribe([&](const jvmti_event &) {
+        ++unsubscribed_calls;
+    });
+
+    events.unsubscribe(removed);
+    events.start(options);
+
+    jvmti_env->ForceGarbageCollection();
+
+    std::thread([] {
+        JNIEnv *jni = nullptr;
+
+        if (vm->get_owner()->AttachCurrentThread(reinterpret_cast<void **>(&jni), nullptr) == JNI_OK)
+        {
+            vm->get_owner()->DetachCurrentThread();
+        }
+    }).join();
+
+    events.stop();
+
+    REQUIRE(collections_started.load() >= 1);
+    REQUIRE(collections_finished.load() >= 1);
+    REQUIRE(threads_started.load() >= 1);
+    REQUIRE(unsubscribed_calls.load() == 0);
+
+    REQUIRE(events.get_delivered() >= 3);
+    REQUIRE(events.get_dropped() == 0);
+}
+
+TEST_CASE("gc telemetry records forced pauses", "[jvmti]")
+{
+    const auto jvmti_env = vm->get_jvmti()->get().get_owner();
+
+    gc_telemetry telemetry(jvmti_env);
+    telemetry.start();
+
+    REQUIRE_FALSE(telemetry.in_gc());
+    REQUIRE_FALSE(telemetry.since_last_gc().has_value());
+
+    constexpr uint64_t forced = 3;
+
+    for (uint64_t i = 0; i < forced; ++i)
+    {
+        jvmti_env->ForceGarbageCollection();
+    }
+
+    REQUIRE(telemetry.get_collections() >= forced);
+    REQUIRE_FALSE(telemetry.in_gc());
+    REQUIRE(telemetry.since_last_gc().has_value());
+
+    const auto pauses = telemetry.snapshot();
+
+    REQUIRE(pauses.pauses >= forced);
+    REQUIRE(pauses.total.count() > 0);
+    REQUIRE(pauses.max >= pauses.mean);
+    REQUIRE(pauses.p50 <= pauses.p99);
+
+    REQUIRE(telemetry.snapshot(false).pauses == 0);
+
+    telemetry.stop();
+    jvmti_env->ForceGarbageCollection();
+
+    REQUIRE(telemetry.snapshot().pauses == 0);
+}
+
+TEST_CASE("perf map lists generated code", "[jvmti]")
+{
+    const auto path = std::filesystem::temp_directory_path() / "znb-perf-test.map";
+
+    perf_map_writer writer(vm->get_jvmti()->get().get_owner());
+
+    perf_map_writer::options options;
+    options.path = path;
+
+    /*
+     * Stubs and code compiled so far are replayed on start, so the map is not empty even without new compilations.
+     */
+    writer.start(options);
+    REQUIRE(writer.get_path() == path);
+
+    writer.stop();
+
+    const size_t entries = writer.get_entries();
+    REQUIRE(entries > 0);
+
+    std::ifstream in(path);
+    size_t lines = 0;
+
+    for (std::string line; std::getline(in, line); ++lines)
+    {
+        const auto first = line.find(' ');
+        const auto second = line.find(' ', first + 1);
+
+        REQUIRE(first != std::string::npos);
+        REQUIRE(second != std::string::npos);
+        REQUIRE(second + 1 < line.size());
+
+        REQUIRE(std::stoull(line.substr(0, first), nullptr, 16) != 0);
+        REQUIRE(std::stoull(line.substr(first + 1, second - first - 1), nullptr, 16) > 0);
+    }
+
+    REQUIRE(lines == entries);
+
+    std::filesystem::remove(path);
+}
+
+namespace
+{
+    /*
+     * Appends a marker byte to the test classes under znb/test/Rewritten* and leaves everything else alone.
+     */
+    class marker_transformer final : public class_transformer
+    {
+    public:
+        [[nodiscard]] std::string get_name() const override
+        {
+            return "marker";
+        }
+
+        [[nodiscard]] bool accepts(const std::string_view class_name) const override
+        {
+            return class_name.starts_with("znb/test/");
+        }
+
+        std::optional<std::vector<unsigned char>> transform(const std::string_view class_name, const std::span<const unsigned char> bytes) override
+        {
+            if (!class_name.starts_with("znb/test/Rewritten"))
+            {
+                return std::nullopt;
+            }
+
+            std::vector<unsigned char> output(bytes.begin(), bytes.end());
+            output.push_back(0xff);
+
+            return output;
+        }
+    };
+
+    std::optional<std::vector<unsigned char>> load_through(class_transform_pipeline &pipeline, jvmtiEnv *jvmti, const char *name,
+                                                           const std::vector<unsigned char> &bytes)
+    {
+        jint length = 0;
+        unsigned char *data = nullptr;
+
+        pipeline.on_class_file_load(jvmti, nullptr, nullptr, nullptr, name, nullptr, static_cast<jint>(bytes.size()), bytes.data(), &length, &data);
+
+        if (data == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        std::vector output(data, data + length);
+        jvmti->Deallocate(data);
+
+        return output;
+    }
+}
+
+TEST_CASE("class transform pipeline caches results across starts", "[jvmti]")
+{
+    const auto jvmti_env = vm->get_jvmti()->get().get_owner();
+    const auto directory = std::filesystem::temp_directory_path() / "znb-transform-test";
+
+    std::filesystem::remove_all(directory);
+
+    const std::vector<unsigned char> bytes = {0xca, 0xfe, 0xba, 0xbe};
+    const std::vector<unsigned char> rewritten = {0xca, 0xfe, 0xba, 0xbe, 0xff};
+
+    class_transform_pipeline::options options;
+    options.cache_directory = directory;
+
+    {
+        class_transform_pipeline pipeline(jvmti_env);
+        pipeline.add(std::make_shared<marker_transformer>());
+        pipeline.start(options);
+
+        REQUIRE_THROWS_AS(pipeline.add(std::make_shared<marker_transformer>()), std::logic_error);
+
+        REQUIRE(load_through(pipeline, jvmti_env, "znb/test/RewrittenA", bytes) == rewritten);
+        REQUIRE_FALSE(load_through(pipeline, jvmti_env, "znb/test/Untouched", bytes).has_value());
+
+        // same bytes under another name must not be answered from the first class' entry
+        REQUIRE(load_through(pipeline, jvmti_env, "znb/test/RewrittenB", bytes) == rewritten);
+        REQUIRE(load_through(pipeline, jvmti_env, "znb/test/RewrittenA", bytes) == rewritten);
+
+        const auto stats = pipeline.get_stats();
+        REQUIRE(stats.transformers.size() == 1);
+        REQUIRE(stats.transformers.front().invocations == 3);
+        REQUIRE(stats.transformers.front().transformed == 2);
+        REQUIRE(stats.cache_hits >= 1);
+        REQUIRE(stats.failures == 0);
+
+        pipeline.stop();
+    }
+
+    size_t class_files = 0;
+
+    for (const auto &file : std::filesystem::directory_iterator(directory))
+    {
+        if (file.path().extension() == ".class")
+        {
+            ++class_files;
+        }
+    }
+
+    REQUIRE(class_files == 2);
+    REQUIRE(std::filesystem::exists(directory / "untouched.index"));
+
+    {
+        class_transform_pipeline pipeline(jvmti_env);
+        pipeline.add(std::make_shared<marker_transformer>());
+        pipeline.start(options);
+
+        REQUIRE(load_through(pipeline, jvmti_env, "znb/test/RewrittenA", bytes) == rewritten);
+        REQUIRE(load_through(pipeline, jvmti_env, "znb/test/RewrittenB", bytes) == rewritten);
+        REQUIRE_FALSE(load_through(pipeline, jvmti_env, "znb/test/Untouched", bytes).has_value());
+
+        const auto stats = pipeline.get_stats();
+        REQUIRE(stats.transformers.front().invocations == 0);
+        REQUIRE(stats.cache_hits >= 3);
+
+        pipeline.stop();
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("jit warm-up finishes before its budget", "[jvmti]")
+{
+    const auto jni = vm->get_env();
+    const auto jvmti_env = vm->get_jvmti()->get().get_owner();
+
+    const klass_signature math(jni, "java/lang/Math");
+    const klass_signature object(jni, "java/lang/Object");
+
+    const int_method max(jni, math, "max", "(II)I", std::nullopt, true);
+    const int_method hash_code(jni, object, "hashCode", "()I", std::nullopt, false);
+
+    REQUIRE_THROWS_AS(jit_warmup::target::from(hash_code), std::invalid_argument);
+
+    /*
+     * Math.max is trivial and, under tiered compilation, never gets past tier 1; it may also be compiled already. Either
+     * way the run has to end long before the budget instead of waiting for a second compilation.
+     */
+    jit_warmup::options options;
+    options.budget = std::chrono::seconds(30);
+
+    jit_warmup warmup(jvmti_env);
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto reports = warmup.run(jni, {jit_warmup::target::from(max)}, options);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+
+    REQUIRE(reports.size() == 1);
+    REQUIRE(reports.front().reached);
+    REQUIRE(reports.front().exceptions == 0);
+    REQUIRE((reports.front().precompiled || reports.front().compilations >= 1));
+    REQUIRE(elapsed < std::chrono::seconds(15));
+
+    /*
+     * A second run sees the code installed by the first one through the replay.
+     */
+    const auto again = warmup.run(jni, {jit_warmup::target::from(max)}, options);
+
+    REQUIRE(again.front().reached);
+    REQUIRE(again.front().precompiled);
+    REQUIRE(again.front().invocations == 0);
+}
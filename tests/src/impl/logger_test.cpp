@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ZNBKit/setup.hpp"
+#include "ZNBKit/debug.hpp"
+#include "ZNBKit/internal/logger.hpp"
+
+namespace
+{
+    class capture_sink final : public znb_kit::log_sink
+    {
+        mutable std::mutex mutex;
+        std::vector<std::pair<znb_kit::log_level, std::string>> records;
+
+    public:
+        std::atomic<size_t> flushes{0};
+
+        void write(const znb_kit::log_record &record) override
+        {
+            std::lock_guard lock(mutex);
+            records.emplace_back(record.level, std::string(record.message));
+        }
+
+        void flush() override
+        {
+            flushes.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool contains(const znb_kit::log_level level, const std::string_view message) const
+        {
+            std::lock_guard lock(mutex);
+
+            return std::ranges::any_of(records, [&](const auto &record) {
+                return record.first == level && record.second == message;
+            });
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            std::lock_guard lock(mutex);
+            return records.size();
+        }
+    };
+
+    /*
+     * Puts the process-wide sink and level back, so the remaining tests log as before.
+     */
+    struct logger_scope
+    {
+        znb_kit::log_level level = znb_kit::logger::get_level();
+
+        ~logger_scope()
+        {
+            znb_kit::logger::set_sink(nullptr);
+            znb_kit::logger::set_level(level);
+        }
+    };
+}
+
+TEST_CASE("logger level filtering")
+{
+    logger_scope scope;
+
+    const auto sink = std::make_shared<capture_sink>();
+    znb_kit::logger::set_sink(sink);
+    REQUIRE(znb_kit::logger::get_sink() == sink);
+
+    znb_kit::logger::set_level(znb_kit::LEVEL_WARN);
+    REQUIRE_FALSE(znb_kit::logger::is_enabled(znb_kit::LEVEL_INFO));
+    REQUIRE(znb_kit::logger::is_enabled(znb_kit::LEVEL_ERROR));
+
+    bool evaluated = false;
+    const auto message = [&evaluated] {
+        evaluated = true;
+        return std::string("hidden");
+    };
+
+    ZNB_LOG_MESSAGE(znb_kit::LEVEL_INFO, message());
+    ZNB_LOG_WARN("warn {}", 1);
+    ZNB_LOG_ERROR("error {}", 2);
+
+    REQUIRE_FALSE(evaluated);
+    REQUIRE_FALSE(sink->contains(znb_kit::LEVEL_INFO, "hidden"));
+    REQUIRE(sink->contains(znb_kit::LEVEL_WARN, "warn 1"));
+    REQUIRE(sink->contains(znb_kit::LEVEL_ERROR, "error 2"));
+
+    znb_kit::logger::set_level(znb_kit::LEVEL_OFF);
+    ZNB_LOG_ERROR("silenced");
+    REQUIRE_FALSE(sink->contains(znb_kit::LEVEL_ERROR, "silenced"));
+
+    znb_kit::logger::set_sink(nullptr);
+    REQUIRE(znb_kit::logger::get_sink() != nullptr);
+    REQUIRE(sink->flushes.load() == 1);
+}
+
+TEST_CASE("debug_print macros map onto logger levels")
+{
+    logger_scope scope;
+
+    const auto sink = std::make_shared<capture_sink>();
+    znb_kit::logger::set_sink(sink);
+    znb_kit::logger::set_level(znb_kit::LEVEL_DEBUG);
+
+    debug_print("plain");
+    debug_print_ignore_formatting("unformatted");
+    debug_print_cerr("problem");
+
+    if constexpr (ZNB_LOG_LEVEL <= ZNB_LOG_LEVEL_DEBUG)
+    {
+        REQUIRE(sink->contains(znb_kit::LEVEL_DEBUG, "plain"));
+    }
+
+    if constexpr (ZNB_LOG_LEVEL <= ZNB_LOG_LEVEL_INFO)
+    {
+        REQUIRE(sink->contains(znb_kit::LEVEL_INFO, "unformatted"));
+    }
+
+    if constexpr (ZNB_LOG_LEVEL <= ZNB_LOG_LEVEL_WARN)
+    {
+        REQUIRE(sink->contains(znb_kit::LEVEL_WARN, "problem"));
+    }
+}
+
+TEST_CASE("async sink flushes while other threads keep logging")
+{
+    const auto target = std::make_shared<capture_sink>();
+
+    {
+        znb_kit::async_sink sink(target);
+
+        std::atomic_bool running{true};
+        std::vector<std::thread> writers;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            writers.emplace_back([&sink, &running] {
+                while (running.load(std::memory_order_relaxed))
+                {
+                    sink.write({znb_kit::LEVEL_INFO, std::chrono::system_clock::now(), __FILE__, __LINE__, "noise"});
+                }
+            });
+        }
+
+        for (int round = 0; round < 16; ++round)
+        {
+            const auto marker = std::format("marker {}", round);
+            sink.write({znb_kit::LEVEL_WARN, std::chrono::system_clock::now(), __FILE__, __LINE__, marker});
+
+            sink.flush();
+            REQUIRE(target->contains(znb_kit::LEVEL_WARN, marker));
+        }
+
+        REQUIRE(target->flushes.load() >= 16);
+
+        running.store(false);
+
+        for (auto &writer : writers)
+        {
+            writer.join();
+        }
+    }
+
+    REQUIRE(target->size() > 16);
+}
+
+TEST_CASE("async sink hands rings back when writing threads exit")
+{
+    const auto target = std::make_shared<capture_sink>();
+    znb_kit::async_sink sink(target);
+
+    // more short-lived threads than there are ring slots
+    for (int i = 0; i < 256; ++i)
+    {
+        std::thread([&sink, i] {
+            sink.write({znb_kit::LEVEL_INFO, std::chrono::system_clock::now(), __FILE__, __LINE__, std::format("thread {}", i)});
+        }).join();
+
+        sink.flush();
+    }
+
+    sink.flush();
+
+    REQUIRE(sink.get_dropped() == 0);
+    REQUIRE(target->size() == 256);
+    REQUIRE(target->contains(znb_kit::LEVEL_INFO, "thread 255"));
+}
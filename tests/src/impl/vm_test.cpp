@@ -2,9 +2,23 @@
 // Created by Damian Netter on 10/05/2025.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <thread>
 
 #include "ZNBKit/setup.hpp"
+#include "ZNBKit/internal/local_ref.hpp"
+#include "ZNBKit/internal/spsc_ring.hpp"
+#include "ZNBKit/internal/util.hpp"
+#include "ZNBKit/internal/weak_cache.hpp"
+#include "ZNBKit/jni/signatures/field_signature.hpp"
+#include "ZNBKit/jni/signatures/method/int_method.hpp"
+#include "ZNBKit/jni/signatures/method_handle.hpp"
+#include "ZNBKit/vm/vm_management.hpp"
 
 TEST_CASE("javavm internal methods availability")
 {
@@ -25,4 +39,518 @@ TEST_CASE("jvmti internal methods availability")
     const auto jvmti = vm->get_jvmti()->get().get_owner();
     jvmti->GetVersionNumber(&version);
     REQUIRE(version > 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE("startup timeline availability")
+{
+    const auto phases = vm->get_timeline();
+
+    REQUIRE_FALSE(phases.empty());
+    REQUIRE(std::ranges::any_of(phases, [](const znb_kit::timeline_phase &phase) {
+        return phase.name == "create_vm" && phase.duration.count() > 0;
+    }));
+
+    const auto json = vm->get_timeline_json();
+    REQUIRE(json.starts_with("{\"dropped\":"));
+}
+
+TEST_CASE("weak references and weak cache")
+{
+    const auto jni = vm->get_env();
+
+    const auto klass = znb_kit::wrapper::search_for_class(jni, "java/lang/Object");
+    const auto constructor = znb_kit::wrapper::get_method(jni, klass, "<init>", "()V", false);
+    const auto object = jni->NewObject(klass, constructor);
+
+    const auto weak = znb_kit::wrapper::add_weak_ref(jni, object);
+
+    REQUIRE_FALSE(znb_kit::wrapper::is_cleared(jni, weak));
+
+    const auto upgraded = znb_kit::wrapper::upgrade_weak_ref(jni, weak);
+
+    REQUIRE(jni->IsSameObject(upgraded, object));
+
+    jni->DeleteLocalRef(upgraded);
+    znb_kit::wrapper::remove_weak_ref(jni, weak);
+
+    znb_kit::weak_cache<int> cache(jni);
+
+    cache.put(jni, object, 42);
+
+    REQUIRE(cache.get(jni, object) == 42);
+    REQUIRE(cache.get(jni, klass) == std::nullopt);
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.purge(jni).empty());
+    REQUIRE(cache.erase(jni, object) == 42);
+    REQUIRE(cache.size() == 0);
+
+    const jint identity = cache.hash(jni, object);
+
+    cache.put(jni, object, identity, 7);
+
+    REQUIRE(cache.get(jni, object, identity) == 7);
+    REQUIRE(cache.get(jni, object) == 7);
+    REQUIRE(cache.erase(jni, object, identity) == 7);
+    REQUIRE(cache.size() == 0);
+
+    SECTION("Collected keys are evicted") {
+        const auto dropped = jni->NewObject(klass, constructor);
+        const jint dropped_identity = cache.hash(jni, dropped);
+
+        cache.put(jni, object, 1);
+        cache.put(jni, dropped, dropped_identity, 2);
+
+        jni->DeleteLocalRef(dropped);
+
+        const auto system = znb_kit::wrapper::search_for_class(jni, "java/lang/System");
+        const auto gc = znb_kit::wrapper::get_method(jni, system, "gc", "()V", true);
+
+        std::vector<int> purged;
+
+        for (int attempt = 0; attempt < 50 && purged.empty(); ++attempt)
+        {
+            jni->CallStaticVoidMethod(system, gc);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            purged = cache.purge(jni);
+        }
+
+        REQUIRE(purged == std::vector{2});
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.get(jni, object) == 1);
+
+        // the bucket of the collected key is gone along with its entry
+        REQUIRE(cache.get(jni, object, dropped_identity) == std::nullopt);
+
+        REQUIRE(cache.erase(jni, object) == 1);
+        znb_kit::wrapper::remove_local_ref(jni, system);
+    }
+
+    cache.release(jni);
+
+    jni->DeleteLocalRef(object);
+    znb_kit::wrapper::remove_local_ref(jni, klass);
+}
+
+TEST_CASE("method handles across threads")
+{
+    const znb_kit::method_handle<jint> abs(vm->get_env(), "java/lang/Math", "abs", "(I)I", true);
+
+    std::vector<jint> results(4);
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        workers.emplace_back([&abs, &results, i] {
+            results[i] = abs.invoke(nullptr, {jvalue{.i = -static_cast<jint>(i)}});
+        });
+    }
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        REQUIRE(results[i] == static_cast<jint>(i));
+    }
+}
+
+TEST_CASE("local references owned by local_ref")
+{
+    const auto jni = vm->get_env();
+    const size_t tracked = znb_kit::local_refs.size();
+
+    {
+        const auto klass = znb_kit::wrapper::search_for_class(jni, "java/lang/System");
+        const auto method = znb_kit::wrapper::get_method(jni, klass, "lineSeparator", "()Ljava/lang/String;", true);
+
+        const auto separator = znb_kit::invoke_object<jstring>(jni, klass, nullptr, method, {});
+
+        REQUIRE(separator);
+        REQUIRE_FALSE(znb_kit::get_string(jni, separator.get(), true).empty());
+
+        znb_kit::wrapper::remove_local_ref(jni, klass);
+    }
+
+    REQUIRE(znb_kit::local_refs.size() == tracked);
+}
+
+TEST_CASE("java exceptions as expected errors")
+{
+    const znb_kit::method_handle<jint> parse(vm->get_env(), "java/lang/Integer", "parseInt", "(Ljava/lang/String;)I", true);
+
+    const auto jni = vm->get_env();
+    const auto input = jni->NewStringUTF("not a number");
+
+    const auto result = parse.try_invoke(nullptr, {jvalue{.l = input}});
+
+    REQUIRE_FALSE(result.has_value());
+    REQUIRE_FALSE(jni->ExceptionCheck());
+    REQUIRE(result.error().get_class_name() == "java.lang.NumberFormatException");
+    REQUIRE(result.error().get_message().find("not a number") != std::string::npos);
+
+    jni->DeleteLocalRef(input);
+}
+
+struct boxed_int
+{
+    jint value;
+};
+
+TEST_CASE("typed field access and struct mapping")
+{
+    const auto jni = vm->get_env();
+    const znb_kit::klass_signature integer(jni, "java/lang/Integer");
+
+    const znb_kit::field_signature<jint> max_value(jni, integer, "MAX_VALUE", true);
+
+    REQUIRE(max_value.get_constant(jni) == 2147483647);
+
+    const auto value_of = znb_kit::wrapper::get_method(jni, integer.get_owner(), "valueOf", "(I)Ljava/lang/Integer;", true);
+    const auto boxed = znb_kit::invoke_object(jni, integer.get_owner(), nullptr, value_of, {jvalue{.i = 1234}});
+
+    const znb_kit::field_signature<jint> value(jni, integer, "value");
+
+    REQUIRE(value.get(jni, boxed.get()) == 1234);
+
+    const auto mapping = znb_kit::make_struct_mapping<boxed_int>(jni, integer, znb_kit::bind<&boxed_int::value>("value"));
+
+    REQUIRE(mapping.read(jni, boxed.get()).value == 1234);
+}
+
+TEST_CASE("thread rings across short-lived threads")
+{
+    SECTION("Slots come back when producer threads exit") {
+        znb_kit::thread_rings<int, 8, 4> rings;
+
+        size_t drained = 0;
+
+        for (int batch = 0; batch < 64; ++batch)
+        {
+            std::vector<std::thread> producers;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                producers.emplace_back([&rings, i] {
+                    REQUIRE(rings.push(i));
+                });
+            }
+
+            for (auto &producer : producers)
+            {
+                producer.join();
+            }
+
+            drained += rings.drain([](int) {});
+        }
+
+        REQUIRE(drained == 64 * 4);
+        REQUIRE(rings.get_dropped() == 0);
+    }
+
+    SECTION("Instances do not evict each other's claims") {
+        std::vector<std::unique_ptr<znb_kit::thread_rings<int, 8, 1>>> instances;
+
+        for (int i = 0; i < 17; ++i)
+        {
+            instances.push_back(std::make_unique<znb_kit::thread_rings<int, 8, 1>>());
+        }
+
+        std::thread([&instances] {
+            for (int round = 0; round < 4; ++round)
+            {
+                REQUIRE(instances.front()->push(round));
+                REQUIRE(instances.back()->push(round));
+            }
+        }).join();
+
+        REQUIRE(instances.front()->drain([](int) {}) == 4);
+        REQUIRE(instances.back()->drain([](int) {}) == 4);
+        REQUIRE(instances.front()->get_dropped() + instances.back()->get_dropped() == 0);
+    }
+
+    SECTION("Preallocated rings bound the producer count") {
+        znb_kit::thread_rings<int, 8, 4> rings(2);
+
+        size_t accepted = 0;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            std::thread([&rings, &accepted] {
+                accepted += rings.push(1) ? 1 : 0;
+            }).join();
+        }
+
+        REQUIRE(accepted == 2);
+        REQUIRE(rings.get_dropped() == 1);
+        REQUIRE(rings.drain([](int) {}) == 2);
+    }
+}
+
+TEST_CASE("class preloading and preload manifests")
+{
+    const auto manifest = std::filesystem::temp_directory_path() / "znb-preload-test.manifest";
+
+    SECTION("Preloading reports loaded and missing classes") {
+        {
+            std::ofstream out(manifest, std::ios::trunc);
+            out << "# comment\n";
+            out << "java/util/ArrayList\n";
+            out << "\n";
+        }
+
+        znb_kit::vm_management::preload_data data;
+        data.classes = {"java.lang.String", "org/dnttr/zephyr/bridge/Native", "org.dnttr.zephyr.DoesNotExist"};
+        data.manifest = manifest;
+        data.threads = 2;
+
+        const auto results = znb_kit::vm_management::preload_classes(vm->get_owner(), JNI_VERSION_1_8, data);
+
+        REQUIRE(results.size() == 4);
+
+        const auto find = [&results](const std::string_view name) {
+            return std::ranges::find(results, name, &znb_kit::preload_result::name);
+        };
+
+        REQUIRE(find("java.lang.String")->loaded);
+        REQUIRE(find("org.dnttr.zephyr.bridge.Native")->loaded);
+        REQUIRE(find("java.util.ArrayList")->loaded);
+
+        const auto missing = find("org.dnttr.zephyr.DoesNotExist");
+        REQUIRE(missing != results.end());
+        REQUIRE_FALSE(missing->loaded);
+        REQUIRE(missing->error.find("ClassNotFoundException") != std::string::npos);
+
+        REQUIRE(vm->get_env()->ExceptionCheck() == JNI_FALSE);
+    }
+
+    SECTION("Recorded manifests list application classes only") {
+        REQUIRE(znb_kit::wrapper::search_for_class(vm->get_env(), "org/dnttr/zephyr/bridge/Native") != nullptr);
+
+        const size_t recorded = znb_kit::vm_management::record_preload_manifest(*vm, manifest);
+        REQUIRE(recorded > 0);
+
+        std::ifstream in(manifest);
+        std::vector<std::string> lines;
+
+        for (std::string line; std::getline(in, line);)
+        {
+            lines.push_back(line);
+        }
+
+        REQUIRE(lines.size() == recorded + 1);
+        REQUIRE(lines.front().starts_with('#'));
+        REQUIRE(std::ranges::find(lines, "org.dnttr.zephyr.bridge.Native") != lines.end());
+        REQUIRE(std::ranges::find(lines, "java.lang.String") == lines.end());
+
+        znb_kit::vm_management::preload_data data;
+        data.manifest = manifest;
+
+        const auto results = znb_kit::vm_management::preload_classes(vm->get_owner(), JNI_VERSION_1_8, data);
+
+        REQUIRE(results.size() == recorded);
+        REQUIRE(std::ranges::find(results, "org.dnttr.zephyr.bridge.Native", &znb_kit::preload_result::name)->loaded);
+    }
+
+    std::filesystem::remove(manifest);
+}
+
+namespace
+{
+    void shutdown_native_method(JNIEnv *, jobject)
+    {
+    }
+}
+
+TEST_CASE("fast shutdown of a wrapped vm")
+{
+    const auto jni = vm->get_env();
+    const auto klass = znb_kit::wrapper::search_for_class(jni, "org/dnttr/zephyr/bridge/Native");
+
+    znb_kit::wrapper::register_natives(jni, "org/dnttr/zephyr/bridge/Native", klass,
+        {znb_kit::jni_native_method("native_method1", "()V", reinterpret_cast<void *>(&shutdown_native_method))});
+
+    auto hook_ran = std::make_shared<std::atomic_bool>(false);
+
+    znb_kit::vm_management::add_shutdown_hook("flag", [hook_ran] {
+        hook_ran->store(true);
+    });
+
+    // abandoned after its deadline, the sleep only delays its detached helper thread
+    znb_kit::vm_management::add_shutdown_hook("slow", [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }, std::chrono::milliseconds(10));
+
+    /*
+     * FAST never destroys the VM and only detaches the calling thread, so it runs on a thread of its own to keep the
+     * VM shared by the other tests alive.
+     */
+    znb_kit::vm_management::shutdown_report report;
+
+    std::thread([&report] {
+        JNIEnv *env = nullptr;
+
+        if (vm->get_owner()->AttachCurrentThread(reinterpret_cast<void **>(&env), nullptr) != JNI_OK)
+        {
+            return;
+        }
+
+        znb_kit::vm_management::shutdown_data data;
+        data.mode = znb_kit::vm_management::shutdown_data::FAST;
+
+        report = znb_kit::vm_management::shutdown_vm(znb_kit::vm_management::wrap_vm(vm->get_owner(), std::nullopt), data);
+    }).join();
+
+    // release() cleared the process-wide VM used by thread_env
+    znb_kit::thread_env::set_vm(vm->get_owner(), JNI_VERSION_1_8);
+
+    REQUIRE(report.mode == znb_kit::vm_management::shutdown_data::FAST);
+    REQUIRE(hook_ran->load());
+    REQUIRE(report.hooks_run == 1);
+    REQUIRE(report.hooks_timed_out == 1);
+    REQUIRE(report.natives_unregistered >= 1);
+    REQUIRE(report.references_deleted == 0);
+    REQUIRE_FALSE(report.destroyed);
+    REQUIRE(std::ranges::find(report.skipped, "DestroyJavaVM") != report.skipped.end());
+
+    REQUIRE(vm->get_env()->GetVersion() > 0);
+
+    znb_kit::wrapper::remove_local_ref(jni, klass);
+}
+
+TEST_CASE("class handles share one global reference")
+{
+    const auto jni = vm->get_env();
+    const size_t baseline = znb_kit::global_tracker::count();
+
+    std::unique_ptr<znb_kit::method_handle<jint>> survivor;
+
+    {
+        const znb_kit::klass_signature math(jni, "java/lang/Math");
+        REQUIRE(znb_kit::global_tracker::count() == baseline + 1);
+
+        const auto copy = math;
+        const znb_kit::int_method abs(jni, copy, "abs", "(I)I", std::nullopt, true);
+        const znb_kit::method_handle<jint> handle(abs);
+        const auto handle_copy = handle;
+
+        REQUIRE(copy.get_owner() == math.get_owner());
+        REQUIRE(handle_copy.get_owner() == math.get_owner());
+        REQUIRE(math.get_handle().use_count() >= 5);
+        REQUIRE(znb_kit::global_tracker::count() == baseline + 1);
+
+        survivor = std::make_unique<znb_kit::method_handle<jint>>(handle_copy);
+    }
+
+    REQUIRE(znb_kit::global_tracker::count() == baseline + 1);
+
+    /*
+     * The last copy goes away on another thread, which releases the reference with that thread's env.
+     */
+    jint result = 0;
+
+    std::thread([survivor = std::move(survivor), &result]() mutable {
+        result = survivor->invoke(nullptr, {jvalue{.i = -7}});
+        survivor.reset();
+    }).join();
+
+    REQUIRE(result == 7);
+    REQUIRE(znb_kit::global_tracker::count() == baseline);
+}
+
+TEST_CASE("cds archive selection")
+{
+    using znb_kit::startup_report;
+    using znb_kit::vm_management;
+
+    const auto directory = std::filesystem::temp_directory_path() / "znb-cds-test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    const auto jar = directory / "app.jar";
+    std::ofstream(jar) << "first build";
+
+    const vm_management::cds_data cds{directory / "archives", "test"};
+
+    vm_management::vm_data data;
+    data.classpath = jar.string();
+
+    const auto prepare = [&cds](const vm_management::vm_data &vm_data) {
+        std::vector<std::string> options;
+        auto report = vm_management::prepare_cds(cds, vm_data, options);
+
+        return std::make_pair(report, options);
+    };
+
+    SECTION("Disabled without a classpath") {
+        const auto [report, options] = prepare(vm_management::vm_data{});
+
+        REQUIRE(report.cds == startup_report::DISABLED);
+        REQUIRE(options.empty());
+    }
+
+    SECTION("Training run first, reuse once the archive exists") {
+        const auto [training, options] = prepare(data);
+
+        REQUIRE(training.cds == startup_report::TRAINING);
+        REQUIRE(std::ranges::find(options, "-XX:+AutoCreateSharedArchive") != options.end());
+        REQUIRE(std::ranges::find(options, "-XX:SharedArchiveFile=" + training.archive.string()) != options.end());
+
+        std::ofstream(training.archive) << "archive";
+
+        const auto [reuse, reuse_options] = prepare(data);
+
+        REQUIRE(reuse.cds == startup_report::REUSE);
+        REQUIRE(reuse.archive == training.archive);
+        REQUIRE(reuse_options == options);
+    }
+
+    SECTION("Key follows the classpath contents and the options") {
+        const auto [original, ignored] = prepare(data);
+        std::ofstream(original.archive) << "archive";
+
+        auto tuned = data;
+        tuned.options = {"-Xmx64m"};
+
+        const auto [with_options, options] = prepare(tuned);
+
+        REQUIRE(with_options.archive != original.archive);
+        REQUIRE(with_options.archive.parent_path() != original.archive.parent_path());
+        REQUIRE(with_options.cds == startup_report::TRAINING);
+        REQUIRE(std::filesystem::exists(original.archive));
+
+        std::ofstream(jar, std::ios::trunc) << "second, longer build";
+
+        const auto [rebuilt, rebuilt_options] = prepare(data);
+
+        REQUIRE(rebuilt.archive != original.archive);
+        REQUIRE(rebuilt.archive.parent_path() == original.archive.parent_path());
+        REQUIRE(rebuilt.cds == startup_report::TRAINING);
+
+        // the archive of the previous build of the same classpath is swept
+        REQUIRE_FALSE(std::filesystem::exists(original.archive));
+    }
+
+    SECTION("Archives of another JVM version are dumped again") {
+        auto [report, options] = prepare(data);
+        std::ofstream(report.archive) << "archive";
+
+        report = prepare(data).first;
+        REQUIRE(report.cds == startup_report::REUSE);
+
+        auto version_path = report.archive;
+        version_path += ".version";
+        std::ofstream(version_path) << "0.0.0-other\n";
+
+        vm_management::verify_cds(vm->get_env(), report);
+        REQUIRE(report.cds == startup_report::TRAINING);
+
+        report.cds = startup_report::REUSE;
+        vm_management::verify_cds(vm->get_env(), report);
+        REQUIRE(report.cds == startup_report::REUSE);
+    }
+
+    std::filesystem::remove_all(directory);
+}
@@ -12,7 +12,23 @@ int main(const int argc, char* argv[]) {
 
     debug_print_ignore_formatting("--------> RUNNING TESTS <--------");
 
-    vm = vm_management::create_and_wrap_vm(ZNI_JAR_PATH);
+    vm_management::vm_data vm_data;
+    vm_data.version = JNI_VERSION_1_8;
+    vm_data.classpath = ZNI_JAR_PATH;
+
+    /*
+     * Everything the JVMTI components under test need, in the one environment the callback hub is installed on.
+     */
+    vm_management::jvmti_data jvmti_data;
+    jvmti_data.version = JVMTI_VERSION;
+    jvmti_data.capabilities.can_get_bytecodes = true;
+    jvmti_data.capabilities.can_tag_objects = true;
+    jvmti_data.capabilities.can_observe_gc = true;
+    jvmti_data.capabilities.can_observe_object_free = true;
+    jvmti_data.capabilities.can_observe_compilation = true;
+    jvmti_data.capabilities.can_sample_allocations = true;
+
+    vm = vm_management::create_and_wrap_vm(vm_data, jvmti_data);
 
     const int out = session.run(argc, argv);
 